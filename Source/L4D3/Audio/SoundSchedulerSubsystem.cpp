@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Audio/SoundSchedulerSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+static TAutoConsoleVariable<bool> CVarShowSoundStats(
+	TEXT("l4d3.Sound.ShowStats"),
+	false,
+	TEXT("Print requested, merged and played sounds per second on screen."));
+
+static FAutoConsoleCommandWithWorld SoundStatsCommand(
+	TEXT("l4d3.Sound.Stats"),
+	TEXT("Log requested, merged and played sounds."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (USoundSchedulerSubsystem* Scheduler = World->GetSubsystem<USoundSchedulerSubsystem>())
+		{
+			Scheduler->LogStats();
+		}
+	}));
+
+void USoundSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!Scheduled.IsEmpty())
+	{
+		GatherListeners();
+		PlayScheduled();
+	}
+
+	// Roll the per second counters
+	TimeInSecond += DeltaTime;
+	if (TimeInSecond >= 1.f)
+	{
+		RequestedPerSecond = FMath::RoundToInt32(RequestedThisSecond / TimeInSecond);
+		MergedPerSecond = FMath::RoundToInt32(MergedThisSecond / TimeInSecond);
+		PlayedPerSecond = FMath::RoundToInt32(PlayedThisSecond / TimeInSecond);
+		RequestedThisSecond = 0;
+		MergedThisSecond = 0;
+		PlayedThisSecond = 0;
+		TimeInSecond = 0.f;
+	}
+
+	// Print stats
+	if (CVarShowSoundStats.GetValueOnGameThread())
+	{
+		GEngine->AddOnScreenDebugMessage((uint64)(UPTRINT)this, 0.f, FColor::Green, FString::Printf(TEXT("Sound: %d requested/s, %d merged/s, %d played/s"),
+			RequestedPerSecond, MergedPerSecond, PlayedPerSecond));
+	}
+}
+
+TStatId USoundSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USoundSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool USoundSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USoundSchedulerSubsystem::RequestSound(USoundBase* Sound, const FVector& Location, ESoundPriority Priority)
+{
+	AddRequest(Sound, Location, Priority, false);
+}
+
+void USoundSchedulerSubsystem::RequestSound2D(USoundBase* Sound, ESoundPriority Priority)
+{
+	AddRequest(Sound, FVector::ZeroVector, Priority, true);
+}
+
+void USoundSchedulerSubsystem::AddRequest(USoundBase* Sound, const FVector& Location, ESoundPriority Priority, bool bIs2D)
+{
+	if (!IsValid(Sound))
+	{
+		return;
+	}
+
+	RequestedThisSecond++;
+	TotalRequested++;
+
+	// Merge into a request for the same sound nearby, 2D sounds merge with any copy of themselves
+	const float MergeRadiusSquared = FMath::Square(GetDefault<UL4D3Settings>()->SoundMergeRadius);
+	for (FScheduledSound& Other : Scheduled)
+	{
+		if (Other.Sound == Sound && Other.bIs2D == bIs2D && (bIs2D || FVector::DistSquared(Other.Location, Location) <= MergeRadiusSquared))
+		{
+			Other.Count++;
+			Other.Priority = FMath::Max(Other.Priority, Priority);
+			MergedThisSecond++;
+			return;
+		}
+	}
+
+	FScheduledSound& Request = Scheduled.AddDefaulted_GetRef();
+	Request.Sound = Sound;
+	Request.Location = Location;
+	Request.Priority = Priority;
+	Request.bIs2D = bIs2D;
+}
+
+void USoundSchedulerSubsystem::GatherListeners()
+{
+	Listeners.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (IsValid(PlayerController) && PlayerController->IsLocalController() && IsValid(PlayerController->PlayerCameraManager))
+		{
+			Listeners.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+}
+
+void USoundSchedulerSubsystem::PlayScheduled()
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	// Priority first, then the closest to any listener. 2D sounds are always at the listener
+	for (FScheduledSound& Request : Scheduled)
+	{
+		float NearestDistance = Request.bIs2D || Listeners.IsEmpty() ? 0.f : MAX_flt;
+		if (!Request.bIs2D)
+		{
+			for (const FVector& Listener : Listeners)
+			{
+				NearestDistance = FMath::Min(NearestDistance, (float)FVector::Distance(Listener, Request.Location));
+			}
+		}
+		Request.Score = (float)Request.Priority * 1e6f - NearestDistance;
+	}
+	Scheduled.Sort([](const FScheduledSound& A, const FScheduledSound& B) { return A.Score > B.Score; });
+
+	const int32 NumToPlay = FMath::Min(Scheduled.Num(), Settings->MaxSoundsPerFrame);
+	for (int32 i = 0; i < NumToPlay; i++)
+	{
+		const FScheduledSound& Request = Scheduled[i];
+
+		// A crowd of merged requests plays a little louder
+		const float Volume = FMath::Min(1.f + 0.1f * (Request.Count - 1), Settings->MaxMergedSoundVolume);
+
+		if (Request.bIs2D)
+		{
+			UGameplayStatics::PlaySound2D(GetWorld(), Request.Sound, Volume);
+		}
+		else
+		{
+			UGameplayStatics::PlaySoundAtLocation(GetWorld(), Request.Sound, Request.Location, Volume);
+		}
+	}
+
+	PlayedThisSecond += NumToPlay;
+	TotalPlayed += NumToPlay;
+
+	Scheduled.Reset();
+}
+
+void USoundSchedulerSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Sound: %d requested/s, %d merged/s, %d played/s, %lld requested and %lld played in total"),
+		RequestedPerSecond, MergedPerSecond, PlayedPerSecond, TotalRequested, TotalPlayed);
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SoundSchedulerSubsystem.generated.h"
+
+class USoundBase;
+
+// Higher priority sounds win over closer lower priority ones
+enum class ESoundPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+struct FScheduledSound
+{
+	USoundBase* Sound = nullptr;
+	FVector Location = FVector::ZeroVector;
+	ESoundPriority Priority = ESoundPriority::Low;
+	bool bIs2D = false;
+
+	// Requests merged into this one
+	int32 Count = 1;
+	float Score = 0.f;
+};
+
+/**
+ * Collects one shot sound requests from zombies and weapons during the frame and plays them at the
+ * end of it. Requests for the same sound close together are merged into one louder voice, then the
+ * rest are ranked by priority and distance to the nearest listener and only MaxSoundsPerFrame play.
+ */
+UCLASS()
+class L4D3_API USoundSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Requests, played at the end of the frame if they make the cut
+	void RequestSound(USoundBase* Sound, const FVector& Location, ESoundPriority Priority);
+	void RequestSound2D(USoundBase* Sound, ESoundPriority Priority);
+
+	// Stats, over the last full second
+	int32 GetRequestedPerSecond() const { return RequestedPerSecond; }
+	int32 GetPlayedPerSecond() const { return PlayedPerSecond; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void AddRequest(USoundBase* Sound, const FVector& Location, ESoundPriority Priority, bool bIs2D);
+	void GatherListeners();
+	void PlayScheduled();
+
+	// Merged requests this frame
+	TArray<FScheduledSound> Scheduled;
+	TArray<FVector> Listeners;
+
+	// Stats
+	float TimeInSecond;
+	int32 RequestedThisSecond;
+	int32 MergedThisSecond;
+	int32 PlayedThisSecond;
+	int32 RequestedPerSecond;
+	int32 MergedPerSecond;
+	int32 PlayedPerSecond;
+	int64 TotalRequested;
+	int64 TotalPlayed;
+};
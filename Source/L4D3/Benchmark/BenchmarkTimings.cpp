@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+
+bool FBenchmarkTimings::bEnabled = false;
+uint64 FBenchmarkTimings::Cycles[(uint8)EBenchmarkBucket::Num] = {};
+EBenchmarkBucket FBenchmarkTimings::ActiveBucket = EBenchmarkBucket::Num;
+uint64 FBenchmarkTimings::ActiveStart = 0;
+
+const TCHAR* FBenchmarkTimings::GetBucketName(EBenchmarkBucket Bucket)
+{
+	switch (Bucket)
+	{
+	case EBenchmarkBucket::AI:			return TEXT("AI");
+	case EBenchmarkBucket::Movement:	return TEXT("Movement");
+	case EBenchmarkBucket::Traces:		return TEXT("Traces");
+	case EBenchmarkBucket::Spawning:	return TEXT("Spawning");
+	case EBenchmarkBucket::Animation:	return TEXT("Animation");
+	default:							return TEXT("Unknown");
+	}
+}
+
+void FBenchmarkTimings::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+	FMemory::Memzero(Cycles);
+	ActiveBucket = EBenchmarkBucket::Num;
+}
+
+void FBenchmarkTimings::ConsumeFrame(double (&OutMilliseconds)[(uint8)EBenchmarkBucket::Num])
+{
+	for (uint8 i = 0; i < (uint8)EBenchmarkBucket::Num; i++)
+	{
+		OutMilliseconds[i] = FPlatformTime::ToMilliseconds64(Cycles[i]);
+		Cycles[i] = 0;
+	}
+}
+
+FScopedBenchmarkTimer::FScopedBenchmarkTimer(EBenchmarkBucket Bucket)
+	: PreviousBucket(FBenchmarkTimings::ActiveBucket)
+	, bActive(FBenchmarkTimings::bEnabled && IsInGameThread())
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	// Charge the outer scope up to now and switch to this one
+	const uint64 Now = FPlatformTime::Cycles64();
+	if (PreviousBucket != EBenchmarkBucket::Num)
+	{
+		FBenchmarkTimings::Cycles[(uint8)PreviousBucket] += Now - FBenchmarkTimings::ActiveStart;
+	}
+	FBenchmarkTimings::ActiveBucket = Bucket;
+	FBenchmarkTimings::ActiveStart = Now;
+}
+
+FScopedBenchmarkTimer::~FScopedBenchmarkTimer()
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	// Charge this scope and resume the outer one, unless the timings were reset while it was open
+	const uint64 Now = FPlatformTime::Cycles64();
+	if (FBenchmarkTimings::ActiveBucket != EBenchmarkBucket::Num)
+	{
+		FBenchmarkTimings::Cycles[(uint8)FBenchmarkTimings::ActiveBucket] += Now - FBenchmarkTimings::ActiveStart;
+	}
+	FBenchmarkTimings::ActiveBucket = PreviousBucket;
+	FBenchmarkTimings::ActiveStart = Now;
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Game thread cost buckets reported by the benchmark mode
+enum class EBenchmarkBucket : uint8
+{
+	AI,
+	Movement,
+	Traces,
+	Spawning,
+	Animation,
+	Num
+};
+
+/**
+ * Per frame game thread time spent in each bucket. Scopes are exclusive, a scope opened inside another
+ * one pauses the outer bucket, so spawning from the virtual horde counts as spawning and not AI.
+ * Only collected while the benchmark is running, and compiled out of shipping builds.
+ */
+struct L4D3_API FBenchmarkTimings
+{
+	static const TCHAR* GetBucketName(EBenchmarkBucket Bucket);
+
+	static void SetEnabled(bool bInEnabled);
+	static bool IsEnabled() { return bEnabled; }
+
+	// Returns the time spent in each bucket since the last call, in milliseconds, and starts a new frame
+	static void ConsumeFrame(double (&OutMilliseconds)[(uint8)EBenchmarkBucket::Num]);
+
+private:
+
+	friend class FScopedBenchmarkTimer;
+
+	static bool bEnabled;
+	static uint64 Cycles[(uint8)EBenchmarkBucket::Num];
+	static EBenchmarkBucket ActiveBucket;
+	static uint64 ActiveStart;
+};
+
+class L4D3_API FScopedBenchmarkTimer
+{
+public:
+
+	explicit FScopedBenchmarkTimer(EBenchmarkBucket Bucket);
+	~FScopedBenchmarkTimer();
+
+private:
+
+	EBenchmarkBucket PreviousBucket;
+	bool bActive;
+};
+
+#if !UE_BUILD_SHIPPING
+#define L4D3_BENCHMARK_SCOPE(Bucket) FScopedBenchmarkTimer ANONYMOUS_VARIABLE(BenchmarkTimer)(EBenchmarkBucket::Bucket)
+#else
+#define L4D3_BENCHMARK_SCOPE(Bucket)
+#endif
@@ -0,0 +1,606 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Benchmark/HordeBenchmarkSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Director/AIDirectorSubsystem.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "L4D3/Player/PlayerCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+
+namespace HordeBenchmark
+{
+	// Idle zombies are placed between these distances from the survivor, inside promote distance so they stay actors
+	static constexpr float IdleMinDistance = 1500.f;
+	static constexpr float IdleMaxDistance = 2800.f;
+
+	// Chasing zombies start close enough to reach the survivor during the run
+	static constexpr float ChaseMinDistance = 600.f;
+	static constexpr float ChaseMaxDistance = 2000.f;
+
+	// Frames to wait for the survivor to spawn before giving up
+	static constexpr int32 MaxSetupFrames = 300;
+
+	// Used when the baseline file doesn't set them. Values under the absolute slack are too small to compare reliably
+	static constexpr double DefaultTolerance = 0.15;
+	static constexpr double DefaultMinAbsoluteMs = 0.1;
+
+	static const TCHAR* ComparedPercentiles[] = { TEXT("P50"), TEXT("P95"), TEXT("P99") };
+
+	static double Percentile(TArray<double> Values, double Fraction)
+	{
+		if (Values.IsEmpty())
+		{
+			return 0.0;
+		}
+		Values.Sort();
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Index];
+	}
+
+	static TSharedRef<FJsonObject> MakeTimingObject(const TArray<double>& Values)
+	{
+		double Sum = 0.0;
+		double Max = 0.0;
+		for (double Value : Values)
+		{
+			Sum += Value;
+			Max = FMath::Max(Max, Value);
+		}
+
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetNumberField(TEXT("Avg"), Values.IsEmpty() ? 0.0 : Sum / Values.Num());
+		Object->SetNumberField(TEXT("P50"), Percentile(Values, 0.50));
+		Object->SetNumberField(TEXT("P95"), Percentile(Values, 0.95));
+		Object->SetNumberField(TEXT("P99"), Percentile(Values, 0.99));
+		Object->SetNumberField(TEXT("Max"), Max);
+		return Object;
+	}
+
+	static TSharedPtr<FJsonObject> FindScenario(const TSharedRef<FJsonObject>& Json, const FString& Name)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Scenarios;
+		if (Json->TryGetArrayField(TEXT("Scenarios"), Scenarios))
+		{
+			for (const TSharedPtr<FJsonValue>& Value : *Scenarios)
+			{
+				const TSharedPtr<FJsonObject>& Scenario = Value->AsObject();
+				if (Scenario.IsValid() && Scenario->GetStringField(TEXT("Name")) == Name)
+				{
+					return Scenario;
+				}
+			}
+		}
+		return nullptr;
+	}
+}
+
+bool UHordeBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("L4D3Benchmark"));
+}
+
+void UHordeBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FParse::Value(FCommandLine::Get(), TEXT("BenchmarkFrames="), Frames);
+	FParse::Value(FCommandLine::Get(), TEXT("BenchmarkWarmup="), WarmupFrames);
+	Frames = FMath::Max(Frames, 1);
+	WarmupFrames = FMath::Max(WarmupFrames, 0);
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("BenchmarkOutput="), OutputPath))
+	{
+		OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / TEXT("Results.json");
+	}
+	else if (FPaths::IsRelative(OutputPath))
+	{
+		OutputPath = FPaths::ProjectDir() / OutputPath;
+	}
+
+	// Regression gate
+	bWriteBaseline = FParse::Param(FCommandLine::Get(), TEXT("BenchmarkWriteBaseline"));
+	bCompareWithBaseline = FParse::Param(FCommandLine::Get(), TEXT("BenchmarkCompare")) || FParse::Value(FCommandLine::Get(), TEXT("BenchmarkBaseline="), BaselinePath);
+	if (BaselinePath.IsEmpty())
+	{
+		BaselinePath = FPaths::ProjectDir() / TEXT("Benchmark") / TEXT("HordeBaseline.json");
+	}
+	else if (FPaths::IsRelative(BaselinePath))
+	{
+		BaselinePath = FPaths::ProjectDir() / BaselinePath;
+	}
+
+	// Idle crowds of growing size, then a full chase and a chase under sustained automatic fire
+	Scenarios = {
+		{ TEXT("Idle100"), 100, false, false },
+		{ TEXT("Idle500"), 500, false, false },
+		{ TEXT("Idle1000"), 1000, false, false },
+		{ TEXT("Chase"), 500, true, false },
+		{ TEXT("Fire"), 500, true, true },
+	};
+
+	// Optional filter, -BenchmarkScenarios=Idle100,Chase
+	FString Filter;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BenchmarkScenarios="), Filter, false))
+	{
+		TArray<FString> Names;
+		Filter.ParseIntoArray(Names, TEXT(","));
+		Scenarios.RemoveAll([&Names](const FScenario& Scenario) { return !Names.Contains(Scenario.Name); });
+	}
+
+	// Scenarios place their own zombies, ambient spawns and panic mobs would make runs incomparable
+	if (UAIDirectorSubsystem* Director = InWorld.GetSubsystem<UAIDirectorSubsystem>())
+	{
+		Director->SetPaused(true);
+	}
+
+	// Nothing is rendered with -nullrhi, pose every zombie as if the whole horde was in view
+	if (IConsoleVariable* IgnoreVisibility = IConsoleManager::Get().FindConsoleVariable(TEXT("l4d3.Anim.IgnoreVisibility")))
+	{
+		IgnoreVisibility->Set(true, ECVF_SetByCode);
+	}
+
+	UE_LOG(LogL4D3, Log, TEXT("Horde benchmark: %d scenarios, %d warmup + %d measured frames each, results to %s"),
+		Scenarios.Num(), WarmupFrames, Frames, *OutputPath);
+
+	Phase = EPhase::Setup;
+	ScenarioIndex = 0;
+	PhaseFrame = 0;
+}
+
+void UHordeBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Wall time between two ticks of this subsystem is the whole frame
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = LastFrameTime > 0.0 ? (Now - LastFrameTime) * 1000.0 : 0.0;
+	LastFrameTime = Now;
+
+	if (Phase == EPhase::Done)
+	{
+		return;
+	}
+
+	if (!Scenarios.IsValidIndex(ScenarioIndex))
+	{
+		Finish();
+		return;
+	}
+
+	const FScenario& Scenario = Scenarios[ScenarioIndex];
+
+	switch (Phase)
+	{
+	case EPhase::Setup:
+		if (IsValid(GetSurvivor()))
+		{
+			SetupScenario(Scenario);
+			Phase = EPhase::Warmup;
+			PhaseFrame = 0;
+		}
+		else if (++PhaseFrame > HordeBenchmark::MaxSetupFrames)
+		{
+			UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: no survivor spawned, is the map's game mode using APlayerCharacter?"));
+			Finish();
+		}
+		break;
+
+	case EPhase::Warmup:
+		DriveSurvivor(Scenario);
+		if (++PhaseFrame >= WarmupFrames)
+		{
+			// Drop whatever the buckets collected during warmup
+			double Discard[(uint8)EBenchmarkBucket::Num];
+			FBenchmarkTimings::ConsumeFrame(Discard);
+			FBenchmarkTimings::SetEnabled(true);
+
+			Results.AddDefaulted_GetRef().Name = Scenario.Name;
+			Phase = EPhase::Measure;
+			PhaseFrame = 0;
+		}
+		break;
+
+	case EPhase::Measure:
+		// This frame's buckets were filled since the previous tick
+		if (PhaseFrame > 0)
+		{
+			RecordFrame(FrameMs);
+		}
+		DriveSurvivor(Scenario);
+		if (++PhaseFrame > Frames)
+		{
+			FBenchmarkTimings::SetEnabled(false);
+			Phase = EPhase::Teardown;
+		}
+		break;
+
+	case EPhase::Teardown:
+		TeardownScenario();
+		ScenarioIndex++;
+		Phase = EPhase::Setup;
+		PhaseFrame = 0;
+		break;
+
+	default:
+		break;
+	}
+}
+
+TStatId UHordeBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHordeBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+bool UHordeBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+APlayerCharacter* UHordeBenchmarkSubsystem::GetSurvivor() const
+{
+	return Cast<APlayerCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+}
+
+void UHordeBenchmarkSubsystem::SetupScenario(const FScenario& Scenario)
+{
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	APlayerCharacter* Survivor = GetSurvivor();
+	if (!IsValid(Pool) || !Pool->GetZombieClass() || !IsValid(NavSystem))
+	{
+		UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: scenario %s needs the zombie pool and a navmesh"), *Scenario.Name);
+		return;
+	}
+
+	// Same layout on every run
+	FMath::RandInit(ScenarioIndex + 1);
+	FMath::SRandInit(ScenarioIndex + 1);
+
+	const float HalfHeight = Pool->GetZombieClass()->GetDefaultObject<AZombieAI>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const float MinDistance = Scenario.bChase ? HordeBenchmark::ChaseMinDistance : HordeBenchmark::IdleMinDistance;
+	const float MaxDistance = Scenario.bChase ? HordeBenchmark::ChaseMaxDistance : HordeBenchmark::IdleMaxDistance;
+	const FVector Center = Survivor->GetActorLocation();
+
+	int32 Spawned = 0;
+	for (int32 Attempt = 0; Attempt < Scenario.NumZombies * 4 && Spawned < Scenario.NumZombies; Attempt++)
+	{
+		// Random point on a ring around the survivor
+		const float Angle = FMath::FRandRange(0.f, UE_TWO_PI);
+		const float Distance = FMath::FRandRange(MinDistance, MaxDistance);
+		const FVector Candidate = Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+
+		FNavLocation NavLocation;
+		if (!NavSystem->ProjectPointToNavigation(Candidate, NavLocation, FVector(200.f, 200.f, 500.f)))
+		{
+			continue;
+		}
+
+		AZombieAI* Zombie = Pool->Acquire(FTransform(FRotator(0.f, FMath::FRandRange(0.f, 360.f), 0.f), NavLocation.Location + FVector(0.f, 0.f, HalfHeight)));
+		if (!IsValid(Zombie))
+		{
+			continue;
+		}
+
+		if (Scenario.bChase)
+		{
+			Zombie->Alert();
+		}
+		Spawned++;
+	}
+
+	// Ready the survivor's gun
+	if (Scenario.bFire)
+	{
+		if (IsValid(Survivor->PrimaryWeapon))
+		{
+			Survivor->EquippedItem = Survivor->PrimaryWeapon;
+			Survivor->PrimaryWeaponState = FWeaponState::MakeFull(Survivor->PrimaryWeapon);
+			Survivor->MarkWeaponStateDirty();
+		}
+		else
+		{
+			UE_LOG(LogL4D3, Warning, TEXT("Horde benchmark: survivor has no primary weapon, scenario %s runs without firing"), *Scenario.Name);
+		}
+	}
+
+	UE_LOG(LogL4D3, Log, TEXT("Horde benchmark: scenario %s, %d of %d zombies spawned"), *Scenario.Name, Spawned, Scenario.NumZombies);
+}
+
+void UHordeBenchmarkSubsystem::DriveSurvivor(const FScenario& Scenario)
+{
+	APlayerCharacter* Survivor = GetSurvivor();
+	if (!IsValid(Survivor))
+	{
+		return;
+	}
+
+	// The survivor can't die, a dead target ends the chase
+	if (Survivor->CurrentHealth != Survivor->MaxHealth)
+	{
+		Survivor->CurrentHealth = Survivor->MaxHealth;
+		Survivor->MarkHealthDirty();
+	}
+
+	if (!Scenario.bChase)
+	{
+		return;
+	}
+
+	// Walk in a slow circle so the horde keeps repathing
+	const float Angle = PhaseFrame * 0.01f;
+	Survivor->AddMovementInput(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f), 0.5f);
+
+	UGunData* Gun = Cast<UGunData>(Survivor->EquippedItem);
+	if (!Scenario.bFire || !IsValid(Gun))
+	{
+		return;
+	}
+
+	// Aim at the closest zombie of the horde
+	UHordeSubsystem* Horde = GetWorld()->GetSubsystem<UHordeSubsystem>();
+	AController* Controller = Survivor->GetController();
+	if (IsValid(Horde) && IsValid(Controller) && Horde->NumZombies() > 0)
+	{
+		const FVector Eye = Survivor->GetPawnViewLocation();
+		int32 Closest = 0;
+		for (int32 i = 1; i < Horde->NumZombies(); i++)
+		{
+			if (FVector::DistSquared(Horde->GetLocation(i), Eye) < FVector::DistSquared(Horde->GetLocation(Closest), Eye))
+			{
+				Closest = i;
+			}
+		}
+		Controller->SetControlRotation((Horde->GetLocation(Closest) - Eye).Rotation());
+	}
+
+	// Bottomless mag, fire as fast as the gun allows
+	if (Survivor->PrimaryWeaponState.AmmoInMag <= 0)
+	{
+		Survivor->PrimaryWeaponState.AmmoInMag = Gun->BulletCapacity;
+		Survivor->MarkWeaponStateDirty();
+	}
+	if (Survivor->CanShoot())
+	{
+		Survivor->Fire();
+		if (Phase == EPhase::Measure && !Results.IsEmpty())
+		{
+			Results.Last().Shots++;
+		}
+	}
+	Survivor->StopFire();
+}
+
+void UHordeBenchmarkSubsystem::RecordFrame(double FrameMs)
+{
+	FScenarioResult& Result = Results.Last();
+
+	double BucketMs[(uint8)EBenchmarkBucket::Num];
+	FBenchmarkTimings::ConsumeFrame(BucketMs);
+
+	Result.FrameMs.Add(FrameMs);
+	for (uint8 i = 0; i < (uint8)EBenchmarkBucket::Num; i++)
+	{
+		Result.BucketMs[i].Add(BucketMs[i]);
+	}
+
+	if (UHordeSubsystem* Horde = GetWorld()->GetSubsystem<UHordeSubsystem>())
+	{
+		Result.ZombieFrames += Horde->NumZombies();
+	}
+}
+
+void UHordeBenchmarkSubsystem::TeardownScenario()
+{
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+
+	// Living and dead, pooled zombies go back to the pool, the rest are destroyed
+	for (TActorIterator<AZombieAI> It(GetWorld()); It; ++It)
+	{
+		AZombieAI* Zombie = *It;
+		if (IsValid(Pool) && Zombie->IsPooled())
+		{
+			Pool->Release(Zombie);
+		}
+		else
+		{
+			Zombie->Destroy();
+		}
+	}
+
+	if (APlayerCharacter* Survivor = GetSurvivor())
+	{
+		Survivor->StopFire();
+	}
+}
+
+TSharedRef<FJsonObject> UHordeBenchmarkSubsystem::MakeResultsJson() const
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("Map"), GetWorld()->GetMapName());
+	Root->SetStringField(TEXT("Configuration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetStringField(TEXT("BuildVersion"), FApp::GetBuildVersion());
+	Root->SetStringField(TEXT("Platform"), ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+	Root->SetNumberField(TEXT("FixedDeltaTime"), FApp::UseFixedTimeStep() ? FApp::GetFixedDeltaTime() : 0.0);
+	Root->SetNumberField(TEXT("Frames"), Frames);
+
+	TArray<TSharedPtr<FJsonValue>> ScenarioValues;
+	for (const FScenarioResult& Result : Results)
+	{
+		TSharedRef<FJsonObject> Scenario = MakeShared<FJsonObject>();
+		Scenario->SetStringField(TEXT("Name"), Result.Name);
+		Scenario->SetNumberField(TEXT("AvgZombies"), Result.FrameMs.IsEmpty() ? 0.0 : (double)Result.ZombieFrames / Result.FrameMs.Num());
+		Scenario->SetNumberField(TEXT("Shots"), Result.Shots);
+		Scenario->SetObjectField(TEXT("FrameMs"), HordeBenchmark::MakeTimingObject(Result.FrameMs));
+
+		TSharedRef<FJsonObject> Buckets = MakeShared<FJsonObject>();
+		for (uint8 i = 0; i < (uint8)EBenchmarkBucket::Num; i++)
+		{
+			Buckets->SetObjectField(FBenchmarkTimings::GetBucketName((EBenchmarkBucket)i), HordeBenchmark::MakeTimingObject(Result.BucketMs[i]));
+		}
+		Scenario->SetObjectField(TEXT("Subsystems"), Buckets);
+
+		ScenarioValues.Add(MakeShared<FJsonValueObject>(Scenario));
+	}
+	Root->SetArrayField(TEXT("Scenarios"), ScenarioValues);
+
+	return Root;
+}
+
+bool UHordeBenchmarkSubsystem::WriteJson(const TSharedRef<FJsonObject>& Json, const FString& Path) const
+{
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	FJsonSerializer::Serialize(Json, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Text, *Path))
+	{
+		UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: could not write %s"), *Path);
+		return false;
+	}
+	return true;
+}
+
+int32 UHordeBenchmarkSubsystem::CompareWithBaseline(const TSharedRef<FJsonObject>& ResultsJson) const
+{
+	FString Text;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(Text, *BaselinePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Baseline) || !Baseline.IsValid())
+	{
+		UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: could not read baseline %s"), *BaselinePath);
+		return 1;
+	}
+
+	double Tolerance = HordeBenchmark::DefaultTolerance;
+	double MinAbsoluteMs = HordeBenchmark::DefaultMinAbsoluteMs;
+	Baseline->TryGetNumberField(TEXT("Tolerance"), Tolerance);
+	Baseline->TryGetNumberField(TEXT("MinAbsoluteMs"), MinAbsoluteMs);
+
+	int32 Regressions = 0;
+
+	// Checks every compared percentile of one timing object, Label names the frame or the subsystem
+	auto CompareTimings = [&](const FString& Scenario, const FString& Label, const TSharedPtr<FJsonObject>& Base, const TSharedPtr<FJsonObject>& Current)
+	{
+		if (!Base.IsValid() || !Current.IsValid())
+		{
+			return;
+		}
+
+		for (const TCHAR* Percentile : HordeBenchmark::ComparedPercentiles)
+		{
+			double BaseMs = 0.0;
+			double CurrentMs = 0.0;
+			if (!Base->TryGetNumberField(Percentile, BaseMs) || !Current->TryGetNumberField(Percentile, CurrentMs))
+			{
+				continue;
+			}
+
+			if (CurrentMs > BaseMs * (1.0 + Tolerance) && CurrentMs - BaseMs > MinAbsoluteMs)
+			{
+				UE_LOG(LogL4D3, Error, TEXT("Horde benchmark regression: %s %s %s %.3f ms, baseline %.3f ms (+%.0f%%, tolerance %.0f%%)"),
+					*Scenario, *Label, Percentile, CurrentMs, BaseMs, BaseMs > 0.0 ? (CurrentMs / BaseMs - 1.0) * 100.0 : 100.0, Tolerance * 100.0);
+				Regressions++;
+			}
+		}
+	};
+
+	for (const FScenarioResult& Result : Results)
+	{
+		const TSharedPtr<FJsonObject> BaseScenario = HordeBenchmark::FindScenario(Baseline.ToSharedRef(), Result.Name);
+		const TSharedPtr<FJsonObject> CurrentScenario = HordeBenchmark::FindScenario(ResultsJson, Result.Name);
+		if (!BaseScenario.IsValid())
+		{
+			// An unchecked scenario must not pass the gate
+			UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: scenario %s has no baseline in %s, record one with -BenchmarkWriteBaseline"), *Result.Name, *BaselinePath);
+			Regressions++;
+			continue;
+		}
+
+		CompareTimings(Result.Name, TEXT("frame"), BaseScenario->GetObjectField(TEXT("FrameMs")), CurrentScenario->GetObjectField(TEXT("FrameMs")));
+
+		const TSharedPtr<FJsonObject>* BaseBuckets;
+		const TSharedPtr<FJsonObject>* CurrentBuckets;
+		if (BaseScenario->TryGetObjectField(TEXT("Subsystems"), BaseBuckets) && CurrentScenario->TryGetObjectField(TEXT("Subsystems"), CurrentBuckets))
+		{
+			for (uint8 i = 0; i < (uint8)EBenchmarkBucket::Num; i++)
+			{
+				const FString Bucket = FBenchmarkTimings::GetBucketName((EBenchmarkBucket)i);
+				const TSharedPtr<FJsonObject>* Base;
+				const TSharedPtr<FJsonObject>* Current;
+				if ((*BaseBuckets)->TryGetObjectField(Bucket, Base) && (*CurrentBuckets)->TryGetObjectField(Bucket, Current))
+				{
+					CompareTimings(Result.Name, Bucket, *Base, *Current);
+				}
+			}
+		}
+	}
+
+	if (Regressions > 0)
+	{
+		UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: %d regressions against %s"), Regressions, *BaselinePath);
+	}
+	else
+	{
+		UE_LOG(LogL4D3, Log, TEXT("Horde benchmark: no regressions against %s"), *BaselinePath);
+	}
+	return Regressions;
+}
+
+void UHordeBenchmarkSubsystem::WriteBaseline(const TSharedRef<FJsonObject>& ResultsJson) const
+{
+	// Keep the tolerances of the current baseline
+	double Tolerance = HordeBenchmark::DefaultTolerance;
+	double MinAbsoluteMs = HordeBenchmark::DefaultMinAbsoluteMs;
+
+	FString Text;
+	TSharedPtr<FJsonObject> OldBaseline;
+	if (FFileHelper::LoadFileToString(Text, *BaselinePath) && FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), OldBaseline) && OldBaseline.IsValid())
+	{
+		OldBaseline->TryGetNumberField(TEXT("Tolerance"), Tolerance);
+		OldBaseline->TryGetNumberField(TEXT("MinAbsoluteMs"), MinAbsoluteMs);
+	}
+
+	ResultsJson->SetNumberField(TEXT("Tolerance"), Tolerance);
+	ResultsJson->SetNumberField(TEXT("MinAbsoluteMs"), MinAbsoluteMs);
+
+	if (WriteJson(ResultsJson, BaselinePath))
+	{
+		UE_LOG(LogL4D3, Log, TEXT("Horde benchmark: wrote baseline %s"), *BaselinePath);
+	}
+}
+
+void UHordeBenchmarkSubsystem::Finish()
+{
+	FBenchmarkTimings::SetEnabled(false);
+	Phase = EPhase::Done;
+
+	const TSharedRef<FJsonObject> ResultsJson = MakeResultsJson();
+	if (WriteJson(ResultsJson, OutputPath))
+	{
+		UE_LOG(LogL4D3, Log, TEXT("Horde benchmark: wrote %d scenarios to %s"), Results.Num(), *OutputPath);
+	}
+
+	// A non zero exit code fails the CI step, so does a run that didn't get through every scenario
+	int32 Regressions = bCompareWithBaseline ? CompareWithBaseline(ResultsJson) : 0;
+	if (Results.Num() < Scenarios.Num())
+	{
+		UE_LOG(LogL4D3, Error, TEXT("Horde benchmark: only %d of %d scenarios ran"), Results.Num(), Scenarios.Num());
+		Regressions++;
+	}
+
+	// Never record an incomplete run as the baseline
+	if (bWriteBaseline && Results.Num() == Scenarios.Num())
+	{
+		WriteBaseline(ResultsJson);
+	}
+
+	FPlatformMisc::RequestExitWithStatus(false, Regressions > 0 ? 1 : 0, TEXT("UHordeBenchmarkSubsystem::Finish"));
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "HordeBenchmarkSubsystem.generated.h"
+
+class AZombieAI;
+class APlayerCharacter;
+
+/**
+ * Headless benchmark mode. Created only when the game is started with -L4D3Benchmark, it runs a fixed list of
+ * horde scenarios around player 0 for a fixed number of frames each, writes the frame times and per bucket
+ * game thread costs to a JSON file and quits. Meant to run without a GPU or audio device, e.g.
+ *
+ *   UnrealEditor L4D3.uproject /Game/L4D3/Maps/Playground -game -nullrhi -nosound -unattended -benchmark -fps=30
+ *       -L4D3Benchmark -BenchmarkFrames=600 -BenchmarkOutput=Saved/Benchmark/Results.json
+ *
+ * -benchmark -fps=30 fixes the simulation step so every run simulates the same amount of game time. The AI
+ * director is paused for the whole run so only the scenario's own zombies are simulated.
+ *
+ * With -BenchmarkCompare the results are checked against the baseline in Benchmark/HordeBaseline.json
+ * (or -BenchmarkBaseline=path). Any frame time or bucket percentile over the baseline by more than the
+ * tolerance is logged as a regression and the game exits with code 1, and so does a scenario missing from
+ * the baseline. -BenchmarkWriteBaseline replaces the baseline with the results of the run.
+ *
+ * Timings only compare on the machine that recorded them, so the checked in baseline starts without
+ * scenarios. To bootstrap the gate, run the command above once on the CI machine with
+ * -BenchmarkWriteBaseline instead of -BenchmarkCompare, commit the updated Benchmark/HordeBaseline.json, then
+ * enable -BenchmarkCompare. Re-record it the same way when the CI hardware or an intended cost changes.
+ */
+UCLASS()
+class L4D3_API UHordeBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FScenario
+	{
+		FString Name;
+		int32 NumZombies;
+		bool bChase;
+		bool bFire;
+	};
+
+	struct FScenarioResult
+	{
+		FString Name;
+		TArray<double> FrameMs;
+		TArray<double> BucketMs[(uint8)EBenchmarkBucket::Num];
+		int64 ZombieFrames = 0;
+		int32 Shots = 0;
+	};
+
+	enum class EPhase : uint8
+	{
+		Setup,
+		Warmup,
+		Measure,
+		Teardown,
+		Done
+	};
+
+	// Scenario steps
+	void SetupScenario(const FScenario& Scenario);
+	void DriveSurvivor(const FScenario& Scenario);
+	void RecordFrame(double FrameMs);
+	void TeardownScenario();
+
+	// Results
+	TSharedRef<class FJsonObject> MakeResultsJson() const;
+	bool WriteJson(const TSharedRef<FJsonObject>& Json, const FString& Path) const;
+	void Finish();
+
+	// Regression gate, returns the number of regressed values
+	int32 CompareWithBaseline(const TSharedRef<FJsonObject>& ResultsJson) const;
+	void WriteBaseline(const TSharedRef<FJsonObject>& ResultsJson) const;
+
+	APlayerCharacter* GetSurvivor() const;
+
+	TArray<FScenario> Scenarios;
+	TArray<FScenarioResult> Results;
+
+	EPhase Phase = EPhase::Done;
+	int32 ScenarioIndex = 0;
+	int32 PhaseFrame = 0;
+	double LastFrameTime = 0.0;
+
+	// Options from the command line
+	int32 Frames = 600;
+	int32 WarmupFrames = 60;
+	FString OutputPath;
+	FString BaselinePath;
+	bool bCompareWithBaseline = false;
+	bool bWriteBaseline = false;
+};
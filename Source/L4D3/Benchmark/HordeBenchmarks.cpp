@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Console benchmarks for the horde systems. Run them in a PIE or game session, results go to LogL4D3.
+
+#include "L4D3/L4D3.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/Enemy/NavFlowField.h"
+#include "L4D3/Enemy/NearestSurvivorQuery.h"
+#include "L4D3/Enemy/ZombieMovementComponent.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "NavigationSystem.h"
+#include "Kismet/GameplayStatics.h"
+
+namespace HordeBenchmarks
+{
+	// Spawns zombies spread over a square around Center
+	static TArray<AZombieAI*> SpawnZombies(UWorld* World, int32 Count, const FVector& Center, float HalfExtent)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<AZombieAI*> Zombies;
+		for (int32 i = 0; i < Count; i++)
+		{
+			const FVector Location = Center + FVector(FMath::FRandRange(-HalfExtent, HalfExtent), FMath::FRandRange(-HalfExtent, HalfExtent), 0.f);
+			if (AZombieAI* Zombie = World->SpawnActor<AZombieAI>(AZombieAI::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+			{
+				Zombies.Add(Zombie);
+			}
+		}
+		return Zombies;
+	}
+
+	static void DestroyZombies(TArray<AZombieAI*>& Zombies)
+	{
+		for (AZombieAI* Zombie : Zombies)
+		{
+			if (IsValid(Zombie))
+			{
+				Zombie->Destroy();
+			}
+		}
+		Zombies.Reset();
+	}
+
+	// The alert query AZombieAI::Damage used before the horde grid
+	static int32 SweepAlert(UWorld* World, const FVector& Center, float Radius)
+	{
+		TArray<FHitResult> OutHits;
+		World->SweepMultiByChannel(OutHits, Center, Center, FQuat::Identity, ECC_WorldStatic, FCollisionShape::MakeSphere(Radius));
+
+		int32 Found = 0;
+		for (const FHitResult& Hit : OutHits)
+		{
+			if (IsValid(Cast<AZombieAI>(Hit.GetActor())))
+			{
+				Found++;
+			}
+		}
+		return Found;
+	}
+
+	static void RunAlertBenchmark(UWorld* World, TArray<int32> Counts, int32 Queries)
+	{
+		if (Counts.IsEmpty())
+		{
+			return;
+		}
+
+		const int32 Count = Counts[0];
+		Counts.RemoveAt(0);
+
+		// Roughly 4 zombies per alert radius, like a dense crowd
+		const float Radius = 500.f;
+		const float HalfExtent = FMath::Sqrt(Count / 4.f) * Radius * 0.5f;
+		const FVector Center = FVector(0.f, 0.f, 100.f);
+		TArray<AZombieAI*> Zombies = SpawnZombies(World, Count, Center, HalfExtent);
+
+		// Give physics a frame to register the new bodies before sweeping
+		FTimerHandle Timer;
+		World->GetTimerManager().SetTimer(Timer, FTimerDelegate::CreateLambda([World, Counts, Queries, Zombies, Center, HalfExtent, Radius]() mutable
+		{
+			UHordeSubsystem* Horde = World->GetSubsystem<UHordeSubsystem>();
+
+			TArray<FVector> QueryPoints;
+			for (int32 i = 0; i < Queries; i++)
+			{
+				QueryPoints.Add(Center + FVector(FMath::FRandRange(-HalfExtent, HalfExtent), FMath::FRandRange(-HalfExtent, HalfExtent), 0.f));
+			}
+
+			// Physics sweep
+			int32 SweepFound = 0;
+			double StartTime = FPlatformTime::Seconds();
+			for (const FVector& Point : QueryPoints)
+			{
+				SweepFound += SweepAlert(World, Point, Radius);
+			}
+			const double SweepTime = FPlatformTime::Seconds() - StartTime;
+
+			// Horde grid
+			int32 GridFound = 0;
+			TArray<AZombieAI*> Found;
+			StartTime = FPlatformTime::Seconds();
+			for (const FVector& Point : QueryPoints)
+			{
+				Found.Reset();
+				Horde->GetZombiesInRadius(Point, Radius, Found);
+				GridFound += Found.Num();
+			}
+			const double GridTime = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogL4D3, Log, TEXT("Alert benchmark, %d zombies, %d queries: sweep %.2f us/query (%d found), grid %.2f us/query (%d found), %.1fx"),
+				Zombies.Num(), Queries, SweepTime * 1e6 / Queries, SweepFound, GridTime * 1e6 / Queries, GridFound,
+				GridTime > 0.0 ? SweepTime / GridTime : 0.0);
+
+			DestroyZombies(Zombies);
+			RunAlertBenchmark(World, Counts, Queries);
+
+		}), 0.5f, false);
+	}
+
+	// Compares one pathfinding query per chasing zombie against one flow field shared by all of them
+	static void RunPathingBenchmark(UWorld* World, int32 Count)
+	{
+		UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		ARecastNavMesh* NavMesh = IsValid(NavSystem) ? Cast<ARecastNavMesh>(NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate)) : nullptr;
+		APawn* Survivor = UGameplayStatics::GetPlayerPawn(World, 0);
+		if (!IsValid(NavMesh) || !IsValid(Survivor))
+		{
+			UE_LOG(LogL4D3, Warning, TEXT("Pathing benchmark needs a navmesh and a player pawn"));
+			return;
+		}
+
+		const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+		const FVector Goal = Survivor->GetActorLocation();
+		const FVector Extent(100.f, 100.f, 250.f);
+
+		// Zombie positions around the survivor
+		TArray<FVector> Starts;
+		for (int32 i = 0; i < Count; i++)
+		{
+			FNavLocation Location;
+			if (NavSystem->GetRandomReachablePointInRadius(Goal, Settings->FlowFieldMaxDistance * 0.5f, Location))
+			{
+				Starts.Add(Location.Location);
+			}
+		}
+
+		// One path per zombie, what MoveToActor does
+		double StartTime = FPlatformTime::Seconds();
+		int32 PathsFound = 0;
+		for (const FVector& Start : Starts)
+		{
+			FPathFindingQuery Query(nullptr, *NavMesh, Start, Goal);
+			if (NavSystem->FindPathSync(Query).IsSuccessful())
+			{
+				PathsFound++;
+			}
+		}
+		const double PathTime = FPlatformTime::Seconds() - StartTime;
+
+		// Build one field
+		StartTime = FPlatformTime::Seconds();
+		FNavFlowField Field;
+		Field.Reset(NavMesh->FindNearestPoly(Goal, Extent), Goal);
+		Field.Expand(*NavMesh, MAX_int32, Settings->FlowFieldMaxDistance);
+		const double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		// Every zombie samples it
+		const float AgentRadius = GetDefault<AZombieAI>()->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		StartTime = FPlatformTime::Seconds();
+		int32 WaypointsFound = 0;
+		for (const FVector& Start : Starts)
+		{
+			FVector Waypoint;
+			if (Field.GetWaypoint(NavMesh->FindNearestPoly(Start, Extent), Start, AgentRadius, Waypoint))
+			{
+				WaypointsFound++;
+			}
+		}
+		const double SampleTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogL4D3, Log, TEXT("Pathing benchmark, %d zombies: pathfinding %.3f ms (%d paths), flow field build %.3f ms (%d polys) + sampling %.3f ms (%d waypoints)"),
+			Starts.Num(), PathTime * 1000.0, PathsFound, BuildTime * 1000.0, Field.NumPolys(), SampleTime * 1000.0, WaypointsFound);
+	}
+
+	// Ticks every zombie's movement Frames times walking toward Goal, returns ms per frame
+	static double TickMovement(TArray<AZombieAI*>& Zombies, const FVector& Goal, int32 Frames)
+	{
+		const float DeltaTime = 1.f / 60.f;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; Frame++)
+		{
+			for (AZombieAI* Zombie : Zombies)
+			{
+				UZombieMovementComponent* Movement = Zombie->GetZombieMovement();
+				Movement->RequestDirectMove((Goal - Zombie->GetActorLocation()).GetSafeNormal2D() * Movement->GetMaxSpeed(), false);
+				Movement->TickComponent(DeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+			}
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames;
+	}
+
+	// Compares full walking against nav walking for the same zombies
+	static void RunMovementBenchmark(UWorld* World, TArray<int32> Counts, int32 Frames)
+	{
+		APawn* Survivor = UGameplayStatics::GetPlayerPawn(World, 0);
+		if (Counts.IsEmpty() || !IsValid(Survivor))
+		{
+			return;
+		}
+
+		const int32 Count = Counts[0];
+		Counts.RemoveAt(0);
+
+		const FVector Goal = Survivor->GetActorLocation();
+		TArray<AZombieAI*> Zombies = SpawnZombies(World, Count, Goal, 3000.f);
+
+		// Let them land before measuring
+		FTimerHandle Timer;
+		World->GetTimerManager().SetTimer(Timer, FTimerDelegate::CreateLambda([World, Counts, Frames, Zombies, Goal]() mutable
+		{
+			double Times[2];
+			int32 NumLightweight = 0;
+
+			for (int32 Pass = 0; Pass < 2; Pass++)
+			{
+				const EMovementMode Mode = Pass == 0 ? MOVE_Walking : MOVE_NavWalking;
+				for (AZombieAI* Zombie : Zombies)
+				{
+					Zombie->GetZombieMovement()->SetMovementMode(Mode);
+				}
+
+				Times[Pass] = TickMovement(Zombies, Goal, Frames);
+			}
+
+			// Nav walking drops back to walking off the navmesh, only count the ones that stayed
+			for (AZombieAI* Zombie : Zombies)
+			{
+				NumLightweight += Zombie->GetZombieMovement()->IsUsingLightweightMovement() ? 1 : 0;
+			}
+
+			UE_LOG(LogL4D3, Log, TEXT("Movement benchmark, %d zombies: walking %.3f ms/frame, nav walking %.3f ms/frame (%d still on navmesh), %.1fx"),
+				Zombies.Num(), Times[0], Times[1], NumLightweight, Times[1] > 0.0 ? Times[0] / Times[1] : 0.0);
+
+			DestroyZombies(Zombies);
+			RunMovementBenchmark(World, Counts, Frames);
+
+		}), 1.f, false);
+	}
+
+	// Compares a scalar nearest survivor loop with square roots against the SIMD kernel
+	static void RunNearestSurvivorBenchmark(int32 Count, int32 NumSurvivors, int32 Iterations)
+	{
+		TArray<FVector> ZombieLocations;
+		for (int32 i = 0; i < Count; i++)
+		{
+			ZombieLocations.Add(FMath::VRand() * FMath::FRandRange(0.f, 5000.f));
+		}
+
+		TArray<FVector> SurvivorLocations;
+		for (int32 i = 0; i < NumSurvivors; i++)
+		{
+			SurvivorLocations.Add(FMath::VRand() * FMath::FRandRange(0.f, 1000.f));
+		}
+
+		// Scalar, one FVector::Distance per pair like the zombies used to do
+		TArray<int32> ScalarNearest;
+		ScalarNearest.SetNumUninitialized(Count);
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			for (int32 i = 0; i < Count; i++)
+			{
+				float BestDistance = MAX_flt;
+				for (int32 Survivor = 0; Survivor < NumSurvivors; Survivor++)
+				{
+					const float Distance = FVector::Distance(ZombieLocations[i], SurvivorLocations[Survivor]);
+					if (Distance < BestDistance)
+					{
+						BestDistance = Distance;
+						ScalarNearest[i] = Survivor;
+					}
+				}
+			}
+		}
+		const double ScalarTime = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+		// Kernel, including filling the query like the horde does every frame
+		FNearestSurvivorQuery Query;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Query.Reset();
+			for (const FVector& Location : ZombieLocations)
+			{
+				Query.AddZombie(Location);
+			}
+			for (const FVector& Location : SurvivorLocations)
+			{
+				Query.AddSurvivor(Location);
+			}
+			Query.Run();
+		}
+		const double KernelTime = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+		int32 Mismatches = 0;
+		for (int32 i = 0; i < Count; i++)
+		{
+			if (Query.GetNearest(i) != ScalarNearest[i])
+			{
+				Mismatches++;
+			}
+		}
+
+		UE_LOG(LogL4D3, Log, TEXT("Nearest survivor benchmark, %d zombies x %d survivors: scalar %.3f ms, kernel %.3f ms, %.1fx (%d mismatches)"),
+			Count, NumSurvivors, ScalarTime * 1000.0, KernelTime * 1000.0, KernelTime > 0.0 ? ScalarTime / KernelTime : 0.0, Mismatches);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs AlertBenchmarkCommand(
+	TEXT("l4d3.Bench.Alert"),
+	TEXT("Compare the zombie alert physics sweep against the horde grid at 100, 500 and 1000 zombies. Optional arg: queries per run."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 Queries = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+		HordeBenchmarks::RunAlertBenchmark(World, { 100, 500, 1000 }, FMath::Max(Queries, 1));
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs PathingBenchmarkCommand(
+	TEXT("l4d3.Bench.Pathing"),
+	TEXT("Compare per zombie pathfinding toward player 0 against a shared flow field at 50, 200 and 500 zombies."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (int32 Count : { 50, 200, 500 })
+		{
+			HordeBenchmarks::RunPathingBenchmark(World, Count);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs MovementBenchmarkCommand(
+	TEXT("l4d3.Bench.Movement"),
+	TEXT("Compare full walking against nav walking zombie movement at 200 and 500 zombies around player 0. Optional arg: frames per run."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 Frames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 60;
+		HordeBenchmarks::RunMovementBenchmark(World, { 200, 500 }, FMath::Max(Frames, 1));
+	}));
+
+static FAutoConsoleCommand NearestSurvivorBenchmarkCommand(
+	TEXT("l4d3.Bench.NearestSurvivor"),
+	TEXT("Compare the scalar nearest survivor search against the SIMD kernel at 1000, 5000 and 10000 zombies with 4 survivors. Optional arg: iterations per run."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+		for (int32 Count : { 1000, 5000, 10000 })
+		{
+			HordeBenchmarks::RunNearestSurvivorBenchmark(Count, 4, FMath::Max(Iterations, 1));
+		}
+	}));
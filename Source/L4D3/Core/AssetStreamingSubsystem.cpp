@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Core/AssetStreamingSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/DataAsset/ItemData.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Pickup/WeaponPickup.h"
+#include "L4D3/Player/PlayerCharacter.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/PlayerController.h"
+
+static FAutoConsoleCommandWithWorld AssetReportCommand(
+	TEXT("l4d3.Assets.Report"),
+	TEXT("Log the streamed item and zombie assets, whether they're loaded and why they were requested."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UAssetStreamingSubsystem* Streaming = World->GetSubsystem<UAssetStreamingSubsystem>())
+		{
+			Streaming->LogReport();
+		}
+	}));
+
+static const TCHAR* GetReasonName(EAssetLoadReason Reason)
+{
+	switch (Reason)
+	{
+	case EAssetLoadReason::LevelLoad:		return TEXT("level load");
+	case EAssetLoadReason::PickupInLevel:	return TEXT("pickup in level");
+	case EAssetLoadReason::PickupInRange:	return TEXT("pickup in range");
+	case EAssetLoadReason::HeldBySurvivor:	return TEXT("held by survivor");
+	}
+	return TEXT("unknown");
+}
+
+void UAssetStreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	LoadZombieAssets();
+}
+
+void UAssetStreamingSubsystem::Deinitialize()
+{
+	if (ZombieHandle.IsValid())
+	{
+		ZombieHandle->ReleaseHandle();
+	}
+	for (TPair<FPrimaryAssetId, FStreamedItem>& Pair : Items)
+	{
+		if (Pair.Value.Handle.IsValid())
+		{
+			Pair.Value.Handle->ReleaseHandle();
+		}
+	}
+	Items.Empty();
+
+	Super::Deinitialize();
+}
+
+void UAssetStreamingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceCheck += DeltaTime;
+	if (TimeSinceCheck < GetDefault<UL4D3Settings>()->ItemPreloadInterval)
+	{
+		return;
+	}
+	TimeSinceCheck = 0.f;
+
+	PreloadItemsInRange();
+}
+
+TStatId UAssetStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAssetStreamingSubsystem, STATGROUP_Tickables);
+}
+
+bool UAssetStreamingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAssetStreamingSubsystem::RegisterPickup(AWeaponPickup* Pickup, FStreamableDelegate OnWorldBundleLoaded)
+{
+	Pickups.Add(Pickup);
+	LoadItem(Pickup->ItemData, UItemData::WorldBundle, EAssetLoadReason::PickupInLevel, OnWorldBundleLoaded);
+}
+
+void UAssetStreamingSubsystem::LoadItem(const UItemData* Item, FName Bundle, EAssetLoadReason Reason, FStreamableDelegate OnLoaded)
+{
+	if (!IsValid(Item))
+	{
+		return;
+	}
+
+	const FPrimaryAssetId AssetId = Item->GetPrimaryAssetId();
+	FStreamedItem& Streamed = Items.FindOrAdd(AssetId);
+
+	const bool bNewBundle = !Streamed.Bundles.Contains(Bundle);
+	if (!bNewBundle && Streamed.Handle.IsValid() && Streamed.Handle->HasLoadCompleted())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	if (bNewBundle)
+	{
+		Streamed.Bundles.Add(Bundle);
+		Streamed.Reasons.Add(Reason);
+	}
+
+	// The asset manager sets the bundle state to exactly what is requested, so ask for every bundle loaded so far
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::Get().LoadPrimaryAsset(AssetId, Streamed.Bundles, OnLoaded);
+	if (Handle.IsValid())
+	{
+		Streamed.Handle = Handle;
+	}
+	else
+	{
+		// Nothing to load, the item isn't registered with the asset manager or has no soft references in the bundle
+		OnLoaded.ExecuteIfBound();
+	}
+}
+
+void UAssetStreamingSubsystem::LoadZombieAssets()
+{
+	TSubclassOf<AZombieAI> ZombieClass = GetDefault<UL4D3Settings>()->ZombieClass.LoadSynchronous();
+	if (!ZombieClass)
+	{
+		return;
+	}
+
+	ZombieAssets.Reset();
+	ZombieClass->GetDefaultObject<AZombieAI>()->GetStreamedAssets(ZombieAssets);
+	ZombieAssets.RemoveAll([](const FSoftObjectPath& Path) { return Path.IsNull(); });
+	if (ZombieAssets.IsEmpty())
+	{
+		return;
+	}
+
+	ZombieHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ZombieAssets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UAssetStreamingSubsystem::PreloadItemsInRange()
+{
+	const float PreloadDistanceSquared = FMath::Square(GetDefault<UL4D3Settings>()->ItemPreloadDistance);
+
+	TArray<FVector> SurvivorLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APlayerCharacter* Survivor = IsValid(PlayerController) ? Cast<APlayerCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (!IsValid(Survivor))
+		{
+			continue;
+		}
+
+		SurvivorLocations.Add(Survivor->GetActorLocation());
+
+		// Loadouts given to the survivor directly never lay in the world
+		LoadItem(Survivor->PrimaryWeapon, UItemData::HeldBundle, EAssetLoadReason::HeldBySurvivor);
+		LoadItem(Survivor->SecondaryWeapon, UItemData::HeldBundle, EAssetLoadReason::HeldBySurvivor);
+		LoadItem(Survivor->EquippedItem, UItemData::HeldBundle, EAssetLoadReason::HeldBySurvivor);
+	}
+
+	for (int32 i = Pickups.Num() - 1; i >= 0; i--)
+	{
+		AWeaponPickup* Pickup = Pickups[i].Get();
+		if (!IsValid(Pickup))
+		{
+			Pickups.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		const FVector Location = Pickup->GetActorLocation();
+		for (const FVector& Survivor : SurvivorLocations)
+		{
+			if (FVector::DistSquared(Location, Survivor) < PreloadDistanceSquared)
+			{
+				LoadItem(Pickup->ItemData, UItemData::HeldBundle, EAssetLoadReason::PickupInRange);
+
+				// Held bundles stay loaded, the pickup has nothing left to stream
+				Pickups.RemoveAtSwap(i, 1, EAllowShrinking::No);
+				break;
+			}
+		}
+	}
+}
+
+void UAssetStreamingSubsystem::LogReport() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Streamed assets: %d items, %d pickups waiting for a survivor"), Items.Num(), Pickups.Num());
+
+	for (const TPair<FPrimaryAssetId, FStreamedItem>& Pair : Items)
+	{
+		const FStreamedItem& Streamed = Pair.Value;
+		const bool bLoaded = Streamed.Handle.IsValid() && Streamed.Handle->HasLoadCompleted();
+
+		for (int32 i = 0; i < Streamed.Bundles.Num(); i++)
+		{
+			UE_LOG(LogL4D3, Log, TEXT("  %s [%s] %s, %s"), *Pair.Key.ToString(), *Streamed.Bundles[i].ToString(),
+				bLoaded ? TEXT("loaded") : TEXT("loading"), GetReasonName(Streamed.Reasons[i]));
+		}
+	}
+
+	const bool bZombiesLoaded = ZombieHandle.IsValid() && ZombieHandle->HasLoadCompleted();
+	UE_LOG(LogL4D3, Log, TEXT("  Zombie assets: %d %s, %s"), ZombieAssets.Num(),
+		bZombiesLoaded ? TEXT("loaded") : TEXT("loading"), GetReasonName(EAssetLoadReason::LevelLoad));
+	for (const FSoftObjectPath& Path : ZombieAssets)
+	{
+		UE_LOG(LogL4D3, Verbose, TEXT("    %s%s"), *Path.ToString(), Path.ResolveObject() ? TEXT("") : TEXT(" (not in memory)"));
+	}
+}
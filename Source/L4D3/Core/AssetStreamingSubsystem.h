@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "AssetStreamingSubsystem.generated.h"
+
+class UItemData;
+class AWeaponPickup;
+
+// Why an asset was streamed in, shown by the report command
+enum class EAssetLoadReason : uint8
+{
+	LevelLoad,
+	PickupInLevel,
+	PickupInRange,
+	HeldBySurvivor
+};
+
+/**
+ * Streams item and zombie assets in before they're needed. Zombie assets and the world bundle of every
+ * pickup are requested when the level starts, the held bundle of an item when a survivor comes near it.
+ */
+UCLASS()
+class L4D3_API UAssetStreamingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Pickups, their world bundle is loaded right away and their held bundle once a survivor is in range
+	void RegisterPickup(AWeaponPickup* Pickup, FStreamableDelegate OnWorldBundleLoaded);
+
+	// Loads a bundle of an item, the delegate runs once it's in memory, right away if it already is
+	void LoadItem(const UItemData* Item, FName Bundle, EAssetLoadReason Reason, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	void LogReport() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void LoadZombieAssets();
+	void PreloadItemsInRange();
+
+	struct FStreamedItem
+	{
+		TArray<FName> Bundles;
+		TArray<EAssetLoadReason> Reasons;
+		TSharedPtr<FStreamableHandle> Handle;
+	};
+
+	TMap<FPrimaryAssetId, FStreamedItem> Items;
+
+	TArray<TWeakObjectPtr<AWeaponPickup>> Pickups;
+
+	// Zombie class assets
+	TSharedPtr<FStreamableHandle> ZombieHandle;
+	TArray<FSoftObjectPath> ZombieAssets;
+
+	float TimeSinceCheck;
+};
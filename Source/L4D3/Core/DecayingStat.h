@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DecayingStat.generated.h"
+
+/**
+ * A value that drains at a fixed rate, stored as the value at a timestamp and worked out whenever
+ * it is read. Nothing has to tick or run a timer to decay it, and the result doesn't depend on frame rate.
+ * Times are world seconds.
+ */
+USTRUCT(BlueprintType)
+struct L4D3_API FDecayingStat
+{
+	GENERATED_BODY()
+
+	// Value at StartTime
+	UPROPERTY()
+	float BaseValue = 0.f;
+	UPROPERTY()
+	double StartTime = 0.0;
+
+	// Amount lost per second
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float DecayPerSecond = 0.f;
+
+	float GetValue(double Now) const
+	{
+		return FMath::Max(BaseValue - DecayPerSecond * (float)(Now - StartTime), 0.f);
+	}
+
+	void SetValue(float Value, double Now)
+	{
+		BaseValue = FMath::Max(Value, 0.f);
+		StartTime = Now;
+	}
+
+	void Add(float Amount, double Now)
+	{
+		SetValue(GetValue(Now) + Amount, Now);
+	}
+
+	// Time at which the value reaches zero
+	double GetEmptyTime() const
+	{
+		return DecayPerSecond > 0.f ? StartTime + BaseValue / DecayPerSecond : MAX_dbl;
+	}
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Core/L4D3Settings.h"
+
+UL4D3Settings::UL4D3Settings()
+{
+	// Significance
+	NearDistance = 1000.f;
+	DormantDistance = 2500.f;
+	MidTickInterval = 0.2f;
+	DormantCheckInterval = 0.5f;
+
+	// Decisions
+	bParallelZombieDecisions = true;
+	ZombieDecisionBatchSize = 64;
+
+	// Movement
+	FullMovementDistance = 600.f;
+	SeparationRadius = 80.f;
+	SeparationStrength = 200.f;
+
+	// Animation
+	AnimSharingDistance = 1500.f;
+	AnimSharingInterval = 0.25f;
+
+	// Alerts
+	AlertGridCellSize = 500.f;
+
+	// Pool
+	ZombiePoolSize = 64;
+
+	// Corpses
+	MaxCorpses = 32;
+	CorpseLifetime = 60.f;
+	CorpseRemovalsPerFrame = 4;
+
+	// Director
+	DirectorFrameBudgetMs = 1.f;
+	PanicMobSize = 50;
+	AmbientSpawnInterval = 10.f;
+	AmbientSpawnCount = 3;
+	MaxAliveZombies = 150;
+	MinSpawnDistance = 800.f;
+	MaxSpawnDistance = 1800.f;
+	SpawnAttemptsPerFrame = 4;
+	MaxSpawnRetryFrames = 30;
+
+	// Flow Field
+	FlowFieldExpansionsPerFrame = 256;
+	FlowFieldMaxDistance = 4000.f;
+	FlowFieldAcceptanceRadius = 10.f;
+
+	// Pathfinding
+	MaxPathRequestsPerFrame = 16;
+	ReturnHomeTolerance = 50.f;
+	HomePathCacheTolerance = 150.f;
+	HomePathRetryDelay = 2.f;
+
+	// Sight
+	SightInterval = 0.5f;
+	MaxSightTracesPerFrame = 24;
+
+	// Sound
+	MaxSoundsPerFrame = 6;
+	SoundMergeRadius = 400.f;
+	MaxMergedSoundVolume = 1.5f;
+
+	// Virtual Horde
+	PromoteDistance = 3000.f;
+	DemoteDistance = 3500.f;
+	MaxPromotionsPerFrame = 4;
+	MaxDemotionsPerFrame = 8;
+	VirtualHordeCheckInterval = 0.25f;
+	VirtualChaseSpeed = 300.f;
+
+	// Streaming
+	ItemPreloadDistance = 1500.f;
+	ItemPreloadInterval = 0.5f;
+
+	// Replication
+	ReplicationGridCellSize = 10000.f;
+	ReplicationGridBias = FVector2D(-200000.f, -200000.f);
+	ZombieNetCullDistance = 8000.f;
+	ZombieNetUpdateFrequency = 20.f;
+	LowFrequencyZombieNetUpdateFrequency = 2.f;
+	PickupNetCullDistance = 5000.f;
+	PickupNetUpdateFrequency = 2.f;
+	ZombieNetSnapDistance = 500.f;
+}
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "L4D3Settings.generated.h"
+
+/**
+ * Project wide gameplay tuning, editable under Project Settings > Game > L4D3.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "L4D3"))
+class L4D3_API UL4D3Settings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	UL4D3Settings();
+
+	// Significance
+	// Zombies closer than this to their target are updated every frame
+	UPROPERTY(Config, EditAnywhere, Category = "Significance")
+	float NearDistance;
+	// Idle zombies further than this go dormant until woken
+	UPROPERTY(Config, EditAnywhere, Category = "Significance")
+	float DormantDistance;
+	// Seconds between updates for zombies between near and dormant distance
+	UPROPERTY(Config, EditAnywhere, Category = "Significance")
+	float MidTickInterval;
+	// Seconds between distance checks on dormant zombies
+	UPROPERTY(Config, EditAnywhere, Category = "Significance")
+	float DormantCheckInterval;
+
+	// Decisions
+	// Run the zombie decision pass on worker threads
+	UPROPERTY(Config, EditAnywhere, Category = "Decisions")
+	bool bParallelZombieDecisions;
+	// Zombies decided per worker task
+	UPROPERTY(Config, EditAnywhere, Category = "Decisions")
+	int32 ZombieDecisionBatchSize;
+
+	// Movement
+	// Zombies closer than this to a survivor use full walking with capsule sweeps, the rest walk on the navmesh
+	UPROPERTY(Config, EditAnywhere, Category = "Movement")
+	float FullMovementDistance;
+	// Zombies closer than this to each other push apart
+	UPROPERTY(Config, EditAnywhere, Category = "Movement")
+	float SeparationRadius;
+	// Speed of the push at full overlap
+	UPROPERTY(Config, EditAnywhere, Category = "Movement")
+	float SeparationStrength;
+
+	// Animation
+	// Zombies further than this from every survivor follow a shared leader pose
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float AnimSharingDistance;
+	// Seconds between leader pose reassignments for each zombie
+	UPROPERTY(Config, EditAnywhere, Category = "Animation")
+	float AnimSharingInterval;
+
+	// Alerts
+	// Cell size of the grid used to find zombies near a location, roughly the alert radius
+	UPROPERTY(Config, EditAnywhere, Category = "Alerts")
+	float AlertGridCellSize;
+
+	// Pool
+	// Zombie blueprint spawned by the pool, defaults to AZombieAI
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	TSoftClassPtr<class AZombieAI> ZombieClass;
+	// Zombies spawned when the level starts
+	UPROPERTY(Config, EditAnywhere, Category = "Pool")
+	int32 ZombiePoolSize;
+
+	// Corpses
+	// Dead zombies left in the world, the oldest and furthest from the survivors are removed first
+	UPROPERTY(Config, EditAnywhere, Category = "Corpses")
+	int32 MaxCorpses;
+	// Seconds a corpse stays before it is removed, 0 keeps it until the cap is hit
+	UPROPERTY(Config, EditAnywhere, Category = "Corpses")
+	float CorpseLifetime;
+	// Corpses released to the pool or destroyed each frame
+	UPROPERTY(Config, EditAnywhere, Category = "Corpses")
+	int32 CorpseRemovalsPerFrame;
+
+	// Director
+	// Time the director may spend spawning zombies each frame
+	UPROPERTY(Config, EditAnywhere, Category = "Director", meta = (Units = "ms"))
+	float DirectorFrameBudgetMs;
+	// Zombies spawned by a panic event
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	int32 PanicMobSize;
+	// Seconds between ambient wanderer spawns, 0 disables them
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	float AmbientSpawnInterval;
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	int32 AmbientSpawnCount;
+	// The director stops spawning while this many zombies are alive
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	int32 MaxAliveZombies;
+	// Spawn ring around a random survivor
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	float MinSpawnDistance;
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	float MaxSpawnDistance;
+	// Candidate locations tried for one spawn before waiting for the next frame
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	int32 SpawnAttemptsPerFrame;
+	// Frames a spawn may wait for a hidden location before it is dropped
+	UPROPERTY(Config, EditAnywhere, Category = "Director")
+	int32 MaxSpawnRetryFrames;
+
+	// Flow Field
+	// Navmesh polys added to a survivor's flow field each frame while it is rebuilt
+	UPROPERTY(Config, EditAnywhere, Category = "Flow Field")
+	int32 FlowFieldExpansionsPerFrame;
+	// Path distance from the survivor covered by the flow field, zombies further away pathfind on their own
+	UPROPERTY(Config, EditAnywhere, Category = "Flow Field")
+	float FlowFieldMaxDistance;
+	// How close a zombie has to get to its waypoint, which sits an agent radius past the portal
+	UPROPERTY(Config, EditAnywhere, Category = "Flow Field")
+	float FlowFieldAcceptanceRadius;
+
+	// Pathfinding
+	// Zombie path requests served per frame, the rest wait in the queue
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	int32 MaxPathRequestsPerFrame;
+	// Idle zombies closer than this to their start location don't walk back
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	float ReturnHomeTolerance;
+	// A cached path home is reused while the zombie is this close to where the path started
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	float HomePathCacheTolerance;
+	// Seconds a zombie that found no path home waits before searching again
+	UPROPERTY(Config, EditAnywhere, Category = "Pathfinding")
+	float HomePathRetryDelay;
+
+	// Sight
+	// Seconds between sight checks for each zombie
+	UPROPERTY(Config, EditAnywhere, Category = "Sight")
+	float SightInterval;
+	// Visibility traces the perception subsystem may run each frame, closest candidates first
+	UPROPERTY(Config, EditAnywhere, Category = "Sight")
+	int32 MaxSightTracesPerFrame;
+
+	// Sound
+	// One shot sounds played each frame, the rest are dropped
+	UPROPERTY(Config, EditAnywhere, Category = "Sound")
+	int32 MaxSoundsPerFrame;
+	// Requests for the same sound closer than this are merged into one voice
+	UPROPERTY(Config, EditAnywhere, Category = "Sound")
+	float SoundMergeRadius;
+	// Volume cap for a voice made from many merged requests
+	UPROPERTY(Config, EditAnywhere, Category = "Sound")
+	float MaxMergedSoundVolume;
+
+	// Virtual Horde
+	// Virtual zombies closer than this to a survivor are promoted to pooled actors
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	float PromoteDistance;
+	// Actor zombies further than this from every survivor are demoted to virtual zombies, keep it above PromoteDistance
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	float DemoteDistance;
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	int32 MaxPromotionsPerFrame;
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	int32 MaxDemotionsPerFrame;
+	// Seconds between promotion and demotion checks
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	float VirtualHordeCheckInterval;
+	// Speed alerted virtual zombies close in on their survivor, in a straight line
+	UPROPERTY(Config, EditAnywhere, Category = "Virtual Horde")
+	float VirtualChaseSpeed;
+
+	// Streaming
+	// Items closer than this to a survivor get their held bundle (icon, gun sound) streamed in
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float ItemPreloadDistance;
+	// Seconds between checks for pickups in range
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	float ItemPreloadInterval;
+
+	// Replication
+	// Size of the replication graph cells zombies and pickups are sorted into
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float ReplicationGridCellSize;
+	// Offset that keeps every playable location in positive grid coordinates
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	FVector2D ReplicationGridBias;
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float ZombieNetCullDistance;
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float ZombieNetUpdateFrequency;
+	// Update rate of dormant, pooled and dead zombies
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float LowFrequencyZombieNetUpdateFrequency;
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float PickupNetCullDistance;
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float PickupNetUpdateFrequency;
+	// Clients snap instead of interpolating when a zombie moved further than this between updates
+	UPROPERTY(Config, EditAnywhere, Category = "Replication")
+	float ZombieNetSnapDistance;
+};
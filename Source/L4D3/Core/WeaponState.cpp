@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Core/WeaponState.h"
+#include "L4D3/DataAsset/GunData.h"
+
+FWeaponState FWeaponState::MakeFull(const UGunData* Gun)
+{
+	FWeaponState State;
+	if (IsValid(Gun))
+	{
+		State.AmmoInMag = Gun->BulletCapacity;
+		State.ReserveAmmo = Gun->StartingReserveAmmo;
+	}
+	return State;
+}
+
+bool FWeaponState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 Mag = FMath::Max(AmmoInMag, 0);
+	uint32 Reserve = FMath::Max(ReserveAmmo, 0);
+	Ar.SerializeIntPacked(Mag);
+	Ar.SerializeIntPacked(Reserve);
+
+	uint8 bHasCooldown = NextFireTime > 0.f;
+	Ar.SerializeBits(&bHasCooldown, 1);
+	if (bHasCooldown)
+	{
+		Ar << NextFireTime;
+	}
+
+	if (Ar.IsLoading())
+	{
+		AmmoInMag = (int32)Mag;
+		ReserveAmmo = (int32)Reserve;
+		if (!bHasCooldown)
+		{
+			NextFireTime = 0.f;
+		}
+	}
+
+	bOutSuccess = true;
+	return true;
+}
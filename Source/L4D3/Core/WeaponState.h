@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WeaponState.generated.h"
+
+class UGunData;
+
+/**
+ * The part of a weapon that changes while it is used. UGunData stays shared, read only config,
+ * every survivor slot and dropped pickup holds its own copy of this instead.
+ */
+USTRUCT(BlueprintType)
+struct L4D3_API FWeaponState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 AmmoInMag = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 ReserveAmmo = 0;
+
+	// World time the weapon can fire again
+	UPROPERTY()
+	float NextFireTime = 0.f;
+
+	// A freshly picked up weapon, full mag and starting reserve
+	static FWeaponState MakeFull(const UGunData* Gun);
+
+	bool CanFire(float Now) const { return AmmoInMag > 0 && Now >= NextFireTime; }
+
+	// Ammo counts are packed, the cooldown is only sent while it is running
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FWeaponState& Other) const
+	{
+		return AmmoInMag == Other.AmmoInMag && ReserveAmmo == Other.ReserveAmmo && NextFireTime == Other.NextFireTime;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FWeaponState> : public TStructOpsTypeTraitsBase2<FWeaponState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -3,3 +3,13 @@
 
 #include "L4D3/DataAsset/GunData.h"
 
+UGunData::UGunData()
+{
+	// Pellets
+	PelletsPerShot = 1;
+	SpreadAngle = 0.f;
+	Penetration = 0;
+
+	// Ammo
+	StartingReserveAmmo = 120;
+}
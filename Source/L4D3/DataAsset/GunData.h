@@ -8,7 +8,7 @@
 
 
 /**
- * 
+ * Shared, read only weapon config. Ammo and cooldowns live in FWeaponState on whoever holds the weapon.
  */
 UCLASS()
 class L4D3_API UGunData : public UItemData
@@ -17,6 +17,8 @@ class L4D3_API UGunData : public UItemData
 	
 public:
 
+	UGunData();
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	int32 Damage;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
@@ -27,9 +29,23 @@ public:
 	float TimeBetweenShots;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	float BulletRange;
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	USoundBase* GunSound;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 AmmoInMag;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (AssetBundles = "Held"))
+	TSoftObjectPtr<USoundBase> GunSound;
+
+	// Pellets
+	// Traces fired per shot, each dealing full damage
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pellets", meta = (ClampMin = "1"))
+	int32 PelletsPerShot;
+	// Half angle of the cone pellets are spread in, in degrees
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pellets", meta = (ClampMin = "0"))
+	float SpreadAngle;
+	// Zombies a pellet can pass through after the first one it hits
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pellets", meta = (ClampMin = "0"))
+	int32 Penetration;
+
+	// Ammo
+	// Reserve a primary weapon comes with, secondary weapons never run out
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo", meta = (ClampMin = "0"))
+	int32 StartingReserveAmmo;
 
 };
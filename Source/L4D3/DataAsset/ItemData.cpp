@@ -3,3 +3,12 @@
 
 #include "../DataAsset/ItemData.h"
 
+const FPrimaryAssetType UItemData::ItemAssetType = TEXT("Item");
+const FName UItemData::WorldBundle = TEXT("World");
+const FName UItemData::HeldBundle = TEXT("Held");
+
+FPrimaryAssetId UItemData::GetPrimaryAssetId() const
+{
+	// Guns and healing items share one type so the asset manager scans them with one rule
+	return FPrimaryAssetId(ItemAssetType, GetFName());
+}
@@ -13,19 +13,34 @@ enum EItemType : uint8
 	Secondary
 };
 
+/**
+ * Item config, registered with the asset manager as an "Item" primary asset. Heavy assets are soft
+ * references split in bundles: "World" is what a pickup lying in the level needs, "Held" what a
+ * survivor needs once the item is close enough to be picked up.
+ */
 UCLASS()
-class L4D3_API UItemData : public UDataAsset
+class L4D3_API UItemData : public UPrimaryDataAsset
 {
 	GENERATED_BODY()
 	
 public:
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	class UStaticMesh* Mesh;
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	static const FPrimaryAssetType ItemAssetType;
+	static const FName WorldBundle;
+	static const FName HeldBundle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<class UStaticMesh> Mesh;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	TEnumAsByte<EItemType> ItemType;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	UTexture2D* ItemIcon;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (AssetBundles = "Held"))
+	TSoftObjectPtr<UTexture2D> ItemIcon;
+
+	// Icon for widgets, null until the "Held" bundle has streamed in
+	UFUNCTION(BlueprintPure)
+	UTexture2D* GetItemIcon() const { return ItemIcon.Get(); }
 };
@@ -0,0 +1,297 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Director/AIDirectorSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "NavigationSystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+static TAutoConsoleVariable<bool> CVarShowDirectorStats(
+	TEXT("l4d3.Director.ShowStats"),
+	false,
+	TEXT("Print the director's queued, spawned and deferred spawns on screen."));
+
+static FAutoConsoleCommandWithWorldAndArgs PanicCommand(
+	TEXT("l4d3.Director.Panic"),
+	TEXT("Start a panic event. Optional arg: mob size."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UAIDirectorSubsystem* Director = World->GetSubsystem<UAIDirectorSubsystem>())
+		{
+			Director->TriggerPanicEvent(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : GetDefault<UL4D3Settings>()->PanicMobSize);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld DirectorStatsCommand(
+	TEXT("l4d3.Director.Stats"),
+	TEXT("Log the director's spawn counters."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UAIDirectorSubsystem* Director = World->GetSubsystem<UAIDirectorSubsystem>())
+		{
+			Director->LogStats();
+		}
+	}));
+
+void UAIDirectorSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(Spawning);
+
+	Super::Tick(DeltaTime);
+
+	// Only the server spawns
+	if (GetWorld()->GetNetMode() == NM_Client || bPaused)
+	{
+		return;
+	}
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	// Gather survivors
+	Survivors.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (IsValid(PlayerController) && IsValid(PlayerController->GetPawn()))
+		{
+			Survivors.Add(PlayerController->GetPawn());
+		}
+	}
+
+	// Ambient wanderers, only topped up once earlier spawns went out and there is room for them
+	TimeSinceAmbientSpawn += DeltaTime;
+	if (Settings->AmbientSpawnInterval > 0.f && TimeSinceAmbientSpawn >= Settings->AmbientSpawnInterval)
+	{
+		TimeSinceAmbientSpawn = 0.f;
+		if (!Survivors.IsEmpty() && NumPendingSpawns() == 0 && NumAliveZombies() < Settings->MaxAliveZombies)
+		{
+			QueueSpawns(Settings->AmbientSpawnCount, false);
+		}
+	}
+
+	// Spawn
+	QueuedThisFrame = QueuedSinceTick;
+	QueuedSinceTick = 0;
+	SpawnedThisFrame = 0;
+
+	if (!Survivors.IsEmpty())
+	{
+		ProcessSpawnQueue();
+	}
+
+	DeferredThisFrame = NumPendingSpawns();
+
+	// Print stats
+	if (CVarShowDirectorStats.GetValueOnGameThread())
+	{
+		GEngine->AddOnScreenDebugMessage((uint64)(UPTRINT)this, 0.f, FColor::Yellow, FString::Printf(TEXT("Director: %d queued, %d spawned, %d deferred"),
+			QueuedThisFrame, SpawnedThisFrame, DeferredThisFrame));
+	}
+}
+
+TStatId UAIDirectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAIDirectorSubsystem, STATGROUP_Tickables);
+}
+
+bool UAIDirectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAIDirectorSubsystem::TriggerPanicEvent(int32 MobSize)
+{
+	QueueSpawns(MobSize, true);
+}
+
+void UAIDirectorSubsystem::QueueSpawns(int32 Count, bool bIsMob)
+{
+	if (bPaused)
+	{
+		return;
+	}
+
+	FDirectorSpawnRequest Request;
+	Request.bIsMob = bIsMob;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		PendingSpawns.Add(Request);
+	}
+
+	QueuedSinceTick += FMath::Max(Count, 0);
+	TotalQueued += FMath::Max(Count, 0);
+}
+
+void UAIDirectorSubsystem::SetPaused(bool bInPaused)
+{
+	bPaused = bInPaused;
+	if (bPaused)
+	{
+		TotalDropped += NumPendingSpawns();
+		PendingSpawns.Reset();
+		PendingHead = 0;
+		TimeSinceAmbientSpawn = 0.f;
+	}
+}
+
+void UAIDirectorSubsystem::ProcessSpawnQueue()
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+	if (!IsValid(Pool) || !Pool->GetZombieClass())
+	{
+		return;
+	}
+
+	const AZombieAI* DefaultZombie = Pool->GetZombieClass()->GetDefaultObject<AZombieAI>();
+	const float HalfHeight = DefaultZombie->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = StartTime + Settings->DirectorFrameBudgetMs / 1000.0;
+
+	int32 Processed = 0;
+	while (PendingHead + Processed < PendingSpawns.Num() && FPlatformTime::Seconds() < Deadline)
+	{
+		FDirectorSpawnRequest& Request = PendingSpawns[PendingHead + Processed];
+
+		// Respect the alive cap, the rest waits for zombies to die
+		if (NumAliveZombies() >= Settings->MaxAliveZombies)
+		{
+			break;
+		}
+
+		FVector Location;
+		if (!FindSpawnLocation(HalfHeight, Location))
+		{
+			// No hidden spot this frame, try again next frame or give up
+			if (++Request.FailedFrames > Settings->MaxSpawnRetryFrames)
+			{
+				Processed++;
+				TotalDropped++;
+			}
+			break;
+		}
+
+		AZombieAI* Zombie = Pool->Acquire(FTransform(FRotator(0.f, FMath::FRandRange(0.f, 360.f), 0.f), Location));
+		if (IsValid(Zombie) && Request.bIsMob)
+		{
+			Zombie->Alert();
+		}
+
+		Processed++;
+		SpawnedThisFrame++;
+		TotalSpawned++;
+	}
+
+	// Advance the head instead of shifting the queue every frame
+	PendingHead += Processed;
+	if (PendingHead >= PendingSpawns.Num())
+	{
+		PendingSpawns.Reset();
+		PendingHead = 0;
+	}
+	else if (PendingHead > PendingSpawns.Num() / 2)
+	{
+		PendingSpawns.RemoveAt(0, PendingHead, EAllowShrinking::No);
+		PendingHead = 0;
+	}
+
+	PeakFrameMs = FMath::Max(PeakFrameMs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+int32 UAIDirectorSubsystem::NumAliveZombies() const
+{
+	if (const UHordeSubsystem* Horde = GetWorld()->GetSubsystem<UHordeSubsystem>())
+	{
+		return Horde->NumZombies();
+	}
+
+	const UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+	return IsValid(Pool) ? Pool->NumActive() : 0;
+}
+
+bool UAIDirectorSubsystem::FindSpawnLocation(float HalfHeight, FVector& OutLocation) const
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!IsValid(NavSystem))
+	{
+		return false;
+	}
+
+	for (int32 Attempt = 0; Attempt < Settings->SpawnAttemptsPerFrame; Attempt++)
+	{
+		const APawn* Survivor = Survivors[FMath::RandRange(0, Survivors.Num() - 1)];
+
+		// Random point on a ring around the survivor
+		const float Angle = FMath::FRandRange(0.f, UE_TWO_PI);
+		const float Distance = FMath::FRandRange(Settings->MinSpawnDistance, Settings->MaxSpawnDistance);
+		const FVector Candidate = Survivor->GetActorLocation() + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+
+		FNavLocation NavLocation;
+		if (!NavSystem->ProjectPointToNavigation(Candidate, NavLocation, FVector(200.f, 200.f, 500.f)))
+		{
+			continue;
+		}
+
+		// Lift the zombie off the navmesh by its capsule
+		const FVector Location = NavLocation.Location + FVector(0.f, 0.f, HalfHeight);
+		if (!IsVisibleToSurvivors(Location))
+		{
+			OutLocation = Location;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UAIDirectorSubsystem::IsVisibleToSurvivors(const FVector& Location) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (!IsValid(PlayerController))
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		// Outside the view cone
+		const float HalfFOV = IsValid(PlayerController->PlayerCameraManager) ? PlayerController->PlayerCameraManager->GetFOVAngle() * 0.5f : 45.f;
+		const FVector ToLocation = (Location - ViewLocation).GetSafeNormal();
+		if (FVector::DotProduct(ViewRotation.Vector(), ToLocation) < FMath::Cos(FMath::DegreesToRadians(HalfFOV)))
+		{
+			continue;
+		}
+
+		// Inside the view cone but behind a wall
+		FCollisionQueryParams Params;
+		Params.AddIgnoredActor(PlayerController->GetPawn());
+		if (!GetWorld()->LineTraceTestByChannel(ViewLocation, Location, ECC_Visibility, Params))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UAIDirectorSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Director: last frame %d queued, %d spawned, %d deferred. Total %d queued, %d spawned, %d dropped, peak %.3f ms per frame"),
+		QueuedThisFrame, SpawnedThisFrame, DeferredThisFrame, TotalQueued, TotalSpawned, TotalDropped, PeakFrameMs);
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AIDirectorSubsystem.generated.h"
+
+struct FDirectorSpawnRequest
+{
+	// Mob zombies rush the survivors, ambient zombies wander
+	bool bIsMob = false;
+
+	// Frames spent without finding a spawn location
+	int32 FailedFrames = 0;
+};
+
+/**
+ * Decides when and where zombies spawn around the survivors. Spawns are queued and
+ * handed out from the zombie pool over several frames under a per frame time budget.
+ */
+UCLASS()
+class L4D3_API UAIDirectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Spawning
+	UFUNCTION(BlueprintCallable, Category = "Director")
+	void TriggerPanicEvent(int32 MobSize);
+	UFUNCTION(BlueprintCallable, Category = "Director")
+	void QueueSpawns(int32 Count, bool bIsMob);
+
+	// A paused director drops its queue and ignores new spawns, e.g. while the benchmark places its own zombies
+	void SetPaused(bool bInPaused);
+	bool IsPaused() const { return bPaused; }
+
+	// Stats
+	int32 GetQueuedThisFrame() const { return QueuedThisFrame; }
+	int32 GetSpawnedThisFrame() const { return SpawnedThisFrame; }
+	int32 GetDeferredThisFrame() const { return DeferredThisFrame; }
+	void LogStats() const;
+
+	int32 NumPendingSpawns() const { return PendingSpawns.Num() - PendingHead; }
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	// Spawning
+	void ProcessSpawnQueue();
+	bool FindSpawnLocation(float HalfHeight, FVector& OutLocation) const;
+	bool IsVisibleToSurvivors(const FVector& Location) const;
+
+	// Zombies in the horde, corpses stay active in the pool for a while
+	int32 NumAliveZombies() const;
+
+	// Queue of spawns, requests before PendingHead are done. Compacted once the head passes half of it
+	TArray<FDirectorSpawnRequest> PendingSpawns;
+	int32 PendingHead;
+	float TimeSinceAmbientSpawn;
+	bool bPaused;
+
+	// Survivors gathered at the start of the frame
+	TArray<APawn*> Survivors;
+
+	// Stats
+	int32 QueuedSinceTick;
+	int32 QueuedThisFrame;
+	int32 SpawnedThisFrame;
+	int32 DeferredThisFrame;
+	int32 TotalQueued;
+	int32 TotalSpawned;
+	int32 TotalDropped;
+	double PeakFrameMs;
+};
@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/CorpseSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Zombies Dead"), STAT_L4D3_ZombiesDead, STATGROUP_L4D3);
+
+static FAutoConsoleCommandWithWorld CorpseStatsCommand(
+	TEXT("l4d3.Corpses.Stats"),
+	TEXT("Log the number of zombie corpses and how many were released or destroyed."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCorpseSubsystem* Corpses = World->GetSubsystem<UCorpseSubsystem>())
+		{
+			Corpses->LogStats();
+		}
+	}));
+
+void UCorpseSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	QueueExpiredCorpses();
+	RemovePending();
+
+	SET_DWORD_STAT(STAT_L4D3_ZombiesDead, Corpses.Num() + PendingRemoval.Num());
+}
+
+TStatId UCorpseSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCorpseSubsystem, STATGROUP_Tickables);
+}
+
+bool UCorpseSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCorpseSubsystem::AddCorpse(AZombieAI* Zombie)
+{
+	Corpses.Add({ Zombie, GetWorld()->GetTimeSeconds() });
+	PeakCorpses = FMath::Max(PeakCorpses, Corpses.Num());
+}
+
+void UCorpseSubsystem::QueueExpiredCorpses()
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Forget bodies that were removed some other way, and queue the ones past their lifetime
+	for (int32 i = Corpses.Num() - 1; i >= 0; i--)
+	{
+		if (!Corpses[i].Zombie.IsValid() || !Corpses[i].Zombie->IsDead())
+		{
+			Corpses.RemoveAt(i, 1, EAllowShrinking::No);
+		}
+		else if (Settings->CorpseLifetime > 0.f && Now - Corpses[i].DeathTime > Settings->CorpseLifetime)
+		{
+			PendingRemoval.Add(Corpses[i].Zombie);
+			Corpses.RemoveAt(i, 1, EAllowShrinking::No);
+		}
+	}
+
+	const int32 Excess = Corpses.Num() - Settings->MaxCorpses;
+	if (Excess <= 0)
+	{
+		return;
+	}
+
+	TArray<FVector> SurvivorLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (IsValid(PlayerController) && IsValid(PlayerController->GetPawn()))
+		{
+			SurvivorLocations.Add(PlayerController->GetPawn()->GetActorLocation());
+		}
+	}
+
+	// Score every body by age and distance, a meter further away counts as much as a second older
+	TArray<TPair<double, int32>> Scores;
+	for (int32 i = 0; i < Corpses.Num(); i++)
+	{
+		const FVector Location = Corpses[i].Zombie->GetActorLocation();
+
+		double NearestDistSquared = SurvivorLocations.IsEmpty() ? 0.0 : MAX_dbl;
+		for (const FVector& Survivor : SurvivorLocations)
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(Location, Survivor));
+		}
+
+		Scores.Add({ (Now - Corpses[i].DeathTime) + FMath::Sqrt(NearestDistSquared) / 100.0, i });
+	}
+	Scores.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key > B.Key; });
+
+	// Queue the worst scoring bodies, then drop them from the list highest index first
+	TArray<int32> Removed;
+	for (int32 i = 0; i < Excess; i++)
+	{
+		PendingRemoval.Add(Corpses[Scores[i].Value].Zombie);
+		Removed.Add(Scores[i].Value);
+	}
+	Removed.Sort(TGreater<int32>());
+	for (int32 Index : Removed)
+	{
+		Corpses.RemoveAt(Index, 1, EAllowShrinking::No);
+	}
+}
+
+void UCorpseSubsystem::RemovePending()
+{
+	const int32 Count = FMath::Min(PendingRemoval.Num(), GetDefault<UL4D3Settings>()->CorpseRemovalsPerFrame);
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		AZombieAI* Zombie = PendingRemoval[i].Get();
+		if (!IsValid(Zombie) || !Zombie->IsDead())
+		{
+			continue;
+		}
+
+		// Pooled zombies are reused, zombies placed in the level are destroyed
+		if (IsValid(Pool) && Zombie->IsPooled())
+		{
+			Pool->Release(Zombie);
+			Released++;
+		}
+		else
+		{
+			Zombie->Destroy();
+			Destroyed++;
+		}
+	}
+
+	PendingRemoval.RemoveAt(0, Count, EAllowShrinking::No);
+}
+
+void UCorpseSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Corpses: %d in the world (peak %d), %d waiting for removal, %d released to the pool, %d destroyed"),
+		Corpses.Num(), PeakCorpses, PendingRemoval.Num(), Released, Destroyed);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CorpseSubsystem.generated.h"
+
+class AZombieAI;
+
+struct FCorpse
+{
+	TWeakObjectPtr<AZombieAI> Zombie;
+	double DeathTime = 0.0;
+};
+
+/**
+ * Keeps track of dead zombies. At most MaxCorpses bodies stay in the world, the oldest and furthest
+ * from the survivors go first, and removed bodies are handed back to the pool (or destroyed) a few
+ * per frame so a panic event dying at once doesn't hitch.
+ */
+UCLASS()
+class L4D3_API UCorpseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Called once the zombie has stopped for death
+	void AddCorpse(AZombieAI* Zombie);
+
+	int32 NumCorpses() const { return Corpses.Num(); }
+	int32 NumPendingRemoval() const { return PendingRemoval.Num(); }
+
+	// Stats
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void QueueExpiredCorpses();
+	void RemovePending();
+
+	// Bodies in the world, in death order
+	TArray<FCorpse> Corpses;
+
+	// Bodies waiting to be released
+	TArray<TWeakObjectPtr<AZombieAI>> PendingRemoval;
+
+	// Stats
+	int32 Released;
+	int32 Destroyed;
+	int32 PeakCorpses;
+};
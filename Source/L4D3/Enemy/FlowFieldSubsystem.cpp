@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/FlowFieldSubsystem.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "NavigationSystem.h"
+#include "GameFramework/PlayerController.h"
+
+// Search extent used to find the poly under a pawn
+static const FVector PolyQueryExtent(100.f, 100.f, 250.f);
+
+void UFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	ARecastNavMesh* NavMesh = GetNavMesh();
+	if (!IsValid(NavMesh))
+	{
+		return;
+	}
+
+	// Forget survivors that are gone
+	for (auto It = Fields.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APawn* Survivor = IsValid(PlayerController) ? PlayerController->GetPawn() : nullptr;
+		if (!IsValid(Survivor))
+		{
+			continue;
+		}
+
+		FSurvivorFlowField& Field = Fields.FindOrAdd(Survivor);
+
+		// Rebuild once the survivor walks onto another poly, zombies keep using the old field meanwhile
+		const FVector SurvivorLocation = Survivor->GetActorLocation();
+		const NavNodeRef SurvivorPoly = NavMesh->FindNearestPoly(SurvivorLocation, PolyQueryExtent);
+		if (SurvivorPoly != INVALID_NAVNODEREF && SurvivorPoly != Field.Building.GetGoalPoly())
+		{
+			Field.Building.Reset(SurvivorPoly, SurvivorLocation);
+			Field.bIsBuilding = true;
+		}
+
+		if (Field.bIsBuilding && Field.Building.Expand(*NavMesh, Settings->FlowFieldExpansionsPerFrame, Settings->FlowFieldMaxDistance))
+		{
+			Swap(Field.Active, Field.Building);
+			Field.bIsBuilding = false;
+
+			// Keep the goal so the swapped out field isn't rebuilt for the same poly
+			Field.Building.Reset(Field.Active.GetGoalPoly(), SurvivorLocation);
+		}
+	}
+}
+
+TStatId UFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+bool UFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UFlowFieldSubsystem::GetChaseWaypoint(const APawn* Survivor, const FVector& Location, float AgentRadius, FVector& OutWaypoint) const
+{
+	const FSurvivorFlowField* Field = Fields.Find(TWeakObjectPtr<APawn>(const_cast<APawn*>(Survivor)));
+	ARecastNavMesh* NavMesh = GetNavMesh();
+	if (!Field || !Field->Active.IsValid() || !IsValid(NavMesh))
+	{
+		return false;
+	}
+
+	// Zombies on the survivor's poly go straight for them
+	const NavNodeRef Poly = NavMesh->FindNearestPoly(Location, PolyQueryExtent);
+	if (Poly == INVALID_NAVNODEREF || Poly == Field->Active.GetGoalPoly())
+	{
+		return false;
+	}
+
+	// A zombie already standing on its waypoint pathfinds instead of stalling on it
+	return Field->Active.GetWaypoint(Poly, Location, AgentRadius, OutWaypoint)
+		&& FVector::DistSquared2D(Location, OutWaypoint) > FMath::Square(GetDefault<UL4D3Settings>()->FlowFieldAcceptanceRadius);
+}
+
+ARecastNavMesh* UFlowFieldSubsystem::GetNavMesh() const
+{
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	return IsValid(NavSystem) ? Cast<ARecastNavMesh>(NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate)) : nullptr;
+}
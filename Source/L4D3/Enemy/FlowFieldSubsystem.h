@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "L4D3/Enemy/NavFlowField.h"
+#include "FlowFieldSubsystem.generated.h"
+
+struct FSurvivorFlowField
+{
+	// Field zombies sample from
+	FNavFlowField Active;
+
+	// Field being built toward the survivor's current poly
+	FNavFlowField Building;
+	bool bIsBuilding = false;
+};
+
+/**
+ * Keeps one navmesh flow field per survivor so every zombie chasing that survivor
+ * steers from a shared field instead of running its own pathfinding query.
+ */
+UCLASS()
+class L4D3_API UFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Finds the next point to walk to from Location toward Survivor, false when there is no field or the zombie should go straight for the survivor
+	bool GetChaseWaypoint(const APawn* Survivor, const FVector& Location, float AgentRadius, FVector& OutWaypoint) const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	ARecastNavMesh* GetNavMesh() const;
+
+	TMap<TWeakObjectPtr<APawn>, FSurvivorFlowField> Fields;
+};
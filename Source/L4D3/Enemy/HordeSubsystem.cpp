@@ -0,0 +1,521 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/VirtualHordeSubsystem.h"
+#include "L4D3/Enemy/ZombieMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "DrawDebugHelpers.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Horde Tick"), STAT_L4D3_HordeTick, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Horde Decisions"), STAT_L4D3_HordeDecisions, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Zombie State Machine"), STAT_L4D3_ZombieStateMachine, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Zombie Alert"), STAT_L4D3_ZombieAlert, STATGROUP_L4D3);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Zombies Idle"), STAT_L4D3_ZombiesIdle, STATGROUP_L4D3);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Zombies Chasing"), STAT_L4D3_ZombiesChasing, STATGROUP_L4D3);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Zombies Dormant"), STAT_L4D3_ZombiesDormant, STATGROUP_L4D3);
+
+static TAutoConsoleVariable<bool> CVarShowHordeTiers(
+	TEXT("l4d3.Horde.ShowTiers"),
+	false,
+	TEXT("Print the number of near, mid and dormant zombies on screen."));
+
+static FAutoConsoleCommandWithWorld HordeTiersCommand(
+	TEXT("l4d3.Horde.Tiers"),
+	TEXT("Log the number of near, mid and dormant zombies."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UHordeSubsystem* Horde = World->GetSubsystem<UHordeSubsystem>())
+		{
+			UE_LOG(LogL4D3, Log, TEXT("Horde: %d zombies, %d near, %d mid, %d dormant"), Horde->NumZombies(),
+				Horde->GetTierCount(EZombieTier::Near), Horde->GetTierCount(EZombieTier::Mid), Horde->GetTierCount(EZombieTier::Dormant));
+		}
+	}));
+
+static TAutoConsoleVariable<bool> CVarDebugHordeAlerts(
+	TEXT("l4d3.Horde.DebugAlerts"),
+	false,
+	TEXT("Draw the radius of zombie alerts."));
+
+void UHordeSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid.SetCellSize(GetDefault<UL4D3Settings>()->AlertGridCellSize);
+}
+
+void UHordeSubsystem::Tick(float DeltaTime)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_HordeTick);
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	// Dormant zombies are only checked every few frames
+	TimeSinceDormantCheck += DeltaTime;
+	const bool bCheckDormant = TimeSinceDormantCheck >= Settings->DormantCheckInterval;
+	if (bCheckDormant)
+	{
+		TimeSinceDormantCheck = 0.f;
+	}
+
+	// Pick the zombies to update this frame, and the zombies that need a target
+	UpdateIndices.Reset();
+	UpdateDeltas.Reset();
+	TargetIndices.Reset();
+	NearestSurvivors.Reset();
+
+	for (int32 Index = 0; Index < Zombies.Num(); Index++)
+	{
+		TimesSinceUpdate[Index] += DeltaTime;
+
+		if (Tiers[Index] == EZombieTier::Dormant)
+		{
+			// Dormant zombies don't move, so the cached location is still valid
+			if (bCheckDormant)
+			{
+				TargetIndices.Add(Index);
+				NearestSurvivors.AddZombie(Locations[Index]);
+			}
+			continue;
+		}
+
+		if (Tiers[Index] == EZombieTier::Mid && TimesSinceUpdate[Index] < Settings->MidTickInterval)
+		{
+			continue;
+		}
+
+		RefreshZombie(Index);
+
+		TargetIndices.Add(Index);
+		NearestSurvivors.AddZombie(Locations[Index]);
+
+		UpdateIndices.Add(Index);
+		UpdateDeltas.Add(TimesSinceUpdate[Index]);
+		TimesSinceUpdate[Index] = 0.f;
+	}
+
+	// Target the nearest living survivor
+	GatherSurvivors();
+	NearestSurvivors.Run();
+
+	for (int32 i = 0; i < TargetIndices.Num(); i++)
+	{
+		const int32 Index = TargetIndices[i];
+		RetargetZombie(Index, i);
+
+		if (Tiers[Index] == EZombieTier::Dormant && Distances[Index] <= Settings->DormantDistance)
+		{
+			WakeZombie(Index);
+		}
+	}
+
+	// Decide what every zombie does, in parallel
+	const float ReturnHomeToleranceSquared = FMath::Square(Settings->ReturnHomeTolerance);
+	const float SeparationRadius = Settings->SeparationRadius;
+	UpdateCommands.SetNumUninitialized(UpdateIndices.Num());
+	UpdateSeparations.SetNumUninitialized(UpdateIndices.Num());
+
+	{
+		L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_HordeDecisions);
+
+		ParallelFor(TEXT("HordeDecisions"), UpdateIndices.Num(), Settings->ZombieDecisionBatchSize, [this, ReturnHomeToleranceSquared, SeparationRadius](int32 i)
+		{
+			UpdateCommands[i] = DecideZombie(UpdateIndices[i], UpdateDeltas[i], ReturnHomeToleranceSquared);
+			UpdateSeparations[i] = ComputeSeparation(UpdateIndices[i], SeparationRadius);
+		}, Settings->bParallelZombieDecisions ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+	}
+
+	// Apply the commands on the game thread
+	{
+		L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_ZombieStateMachine);
+
+		for (int32 i = 0; i < UpdateIndices.Num(); i++)
+		{
+			const int32 Index = UpdateIndices[i];
+			ApplyCommands(Index, UpdateCommands[i]);
+
+			if (UZombieMovementComponent* Movement = Zombies[Index]->GetZombieMovement())
+			{
+				Movement->UpdateMovementLOD(Distances[Index], UpdateSeparations[i]);
+			}
+
+			UpdateTier(Index);
+		}
+	}
+
+#if STATS
+	int32 NumChasing = 0;
+	for (EEnemyState State : States)
+	{
+		NumChasing += State == EEnemyState::EChaseState ? 1 : 0;
+	}
+	SET_DWORD_STAT(STAT_L4D3_ZombiesIdle, States.Num() - NumChasing);
+	SET_DWORD_STAT(STAT_L4D3_ZombiesChasing, NumChasing);
+	SET_DWORD_STAT(STAT_L4D3_ZombiesDormant, GetTierCount(EZombieTier::Dormant));
+#endif
+
+	// Print tiers
+	if (CVarShowHordeTiers.GetValueOnGameThread())
+	{
+		GEngine->AddOnScreenDebugMessage((uint64)(UPTRINT)this, 0.f, FColor::Green, FString::Printf(TEXT("Horde: %d near, %d mid, %d dormant"),
+			GetTierCount(EZombieTier::Near), GetTierCount(EZombieTier::Mid), GetTierCount(EZombieTier::Dormant)));
+	}
+}
+
+void UHordeSubsystem::RefreshZombie(int32 Index)
+{
+	// Update distance between target and zombie
+	Locations[Index] = Zombies[Index]->GetActorLocation();
+	Forwards[Index] = Zombies[Index]->GetActorForwardVector();
+	Grid.Update(Index, Locations[Index]);
+}
+
+void UHordeSubsystem::GatherSurvivors()
+{
+	Survivors.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APlayerCharacter* Survivor = IsValid(PlayerController) ? Cast<APlayerCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (IsValid(Survivor) && !Survivor->IsDead())
+		{
+			Survivors.Add(Survivor);
+			NearestSurvivors.AddSurvivor(Survivor->GetActorLocation());
+		}
+	}
+}
+
+void UHordeSubsystem::RetargetZombie(int32 Index, int32 QueryIndex)
+{
+	// Nobody left to chase
+	if (Survivors.IsEmpty())
+	{
+		Distances[Index] = MAX_flt;
+		return;
+	}
+
+	APlayerCharacter* Survivor = Survivors[NearestSurvivors.GetNearest(QueryIndex)];
+	Targets[Index] = Survivor;
+	Zombies[Index]->Target = Survivor;
+
+	// Only the winning distance needs the square root
+	Distances[Index] = FMath::Sqrt(NearestSurvivors.GetDistanceSquared(QueryIndex));
+}
+
+EZombieCommand UHordeSubsystem::DecideZombie(int32 Index, float DeltaTime, float ReturnHomeToleranceSquared)
+{
+	EZombieCommand Commands = EZombieCommand::None;
+
+	switch (States[Index])
+	{
+	case EIdleState:
+		if (CanSeeTarget[Index])
+		{
+			// Chase player, growl once on spotting them
+			States[Index] = EEnemyState::EChaseState;
+			Commands |= EZombieCommand::EnterChase | EZombieCommand::Growl;
+		}
+		else if (!IsMoving[Index] && FVector::DistSquared2D(Locations[Index], StartLocations[Index]) > ReturnHomeToleranceSquared)
+		{
+			// Player too far, return to start location
+			Commands |= EZombieCommand::ReturnHome;
+		}
+		break;
+
+	case EChaseState:
+		if (Distances[Index] <= AttackingDistances[Index])
+		{
+			// Stop movement
+			if (IsMoving[Index])
+			{
+				Commands |= EZombieCommand::Stop;
+			}
+
+			if (AttackTimers[Index] >= TimesBetweenAttacks[Index])
+			{
+				// Attack
+				Commands |= EZombieCommand::Attack | EZombieCommand::Growl;
+
+				// Reset timer
+				AttackTimers[Index] = 0;
+			}
+		}
+		else if (Distances[Index] <= ChaseDistances[Index])
+		{
+			// Chase, also after every flow field hop, so no growl here
+			if (!IsMoving[Index])
+			{
+				Commands |= EZombieCommand::Chase;
+			}
+		}
+		else
+		{
+			// Lost the player
+			CanSeeTarget[Index] = false;
+			States[Index] = EEnemyState::EIdleState;
+			Commands |= EZombieCommand::LoseTarget;
+		}
+		break;
+
+	default:
+		States[Index] = EEnemyState::EIdleState;
+		Commands |= EZombieCommand::LoseTarget;
+		break;
+	}
+
+	// Update time since last attack
+	AttackTimers[Index] += DeltaTime;
+
+	return Commands;
+}
+
+FVector UHordeSubsystem::ComputeSeparation(int32 Index, float Radius) const
+{
+	if (Radius <= 0.f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Runs per zombie inside ParallelFor, keep the usual crowd on the stack instead of the heap
+	TArray<int32, TInlineAllocator<32>> Neighbours;
+	Grid.QuerySphere(Locations[Index], Radius, Locations, Neighbours);
+
+	// Push away from every neighbour, harder the more they overlap
+	FVector Push = FVector::ZeroVector;
+	for (int32 Neighbour : Neighbours)
+	{
+		if (Neighbour == Index)
+		{
+			continue;
+		}
+
+		const FVector Away = (Locations[Index] - Locations[Neighbour]) * FVector(1.f, 1.f, 0.f);
+		const float Distance = Away.Size();
+		Push += Distance > KINDA_SMALL_NUMBER ? Away / Distance * (1.f - Distance / Radius) : FVector::ZeroVector;
+	}
+
+	return Push.GetClampedToMaxSize(1.f);
+}
+
+void UHordeSubsystem::ApplyCommands(int32 Index, EZombieCommand Commands)
+{
+	if (Commands == EZombieCommand::None)
+	{
+		return;
+	}
+
+	AZombieAI* Zombie = Zombies[Index];
+
+	// States
+	if (EnumHasAnyFlags(Commands, EZombieCommand::EnterChase))
+	{
+		SetState(Index, EEnemyState::EChaseState);
+	}
+	if (EnumHasAnyFlags(Commands, EZombieCommand::LoseTarget))
+	{
+		Zombie->bCanSeePlayer = false;
+		SetState(Index, EEnemyState::EIdleState);
+	}
+
+	// Movement
+	if (EnumHasAnyFlags(Commands, EZombieCommand::ReturnHome))
+	{
+		Zombie->ReturnToStart();
+	}
+	if (EnumHasAnyFlags(Commands, EZombieCommand::Stop))
+	{
+		Zombie->StopMoving();
+	}
+	if (EnumHasAnyFlags(Commands, EZombieCommand::Chase))
+	{
+		Zombie->ChaseTarget();
+	}
+
+	// Attack
+	if (EnumHasAnyFlags(Commands, EZombieCommand::Attack))
+	{
+		Zombie->Attack();
+	}
+
+	// Sound
+	if (EnumHasAnyFlags(Commands, EZombieCommand::Growl))
+	{
+		Zombie->PlayRandomGrowl();
+	}
+}
+
+void UHordeSubsystem::UpdateTier(int32 Index)
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	EZombieTier NewTier = EZombieTier::Mid;
+	if (Distances[Index] <= Settings->NearDistance)
+	{
+		NewTier = EZombieTier::Near;
+	}
+	else if (States[Index] == EEnemyState::EIdleState && !IsMoving[Index] && Distances[Index] > Settings->DormantDistance)
+	{
+		NewTier = EZombieTier::Dormant;
+	}
+
+	if (NewTier != Tiers[Index])
+	{
+		SetTier(Index, NewTier);
+	}
+}
+
+void UHordeSubsystem::SetTier(int32 Index, EZombieTier NewTier)
+{
+	TierCounts[(uint8)Tiers[Index]]--;
+	TierCounts[(uint8)NewTier]++;
+
+	Tiers[Index] = NewTier;
+	Zombies[Index]->ApplyTier(NewTier, GetDefault<UL4D3Settings>()->MidTickInterval);
+}
+
+void UHordeSubsystem::WakeZombie(int32 Index)
+{
+	if (Tiers[Index] == EZombieTier::Dormant)
+	{
+		SetTier(Index, EZombieTier::Mid);
+
+		// Update on the next frame
+		TimesSinceUpdate[Index] = GetDefault<UL4D3Settings>()->MidTickInterval;
+	}
+}
+
+TStatId UHordeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHordeSubsystem, STATGROUP_Tickables);
+}
+
+bool UHordeSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UHordeSubsystem::RegisterZombie(AZombieAI* Zombie)
+{
+	const int32 Index = Zombies.Add(Zombie);
+
+	Targets.Add(Zombie->Target);
+	States.Add(Zombie->ActiveState);
+	Locations.Add(Zombie->GetActorLocation());
+	Forwards.Add(Zombie->GetActorForwardVector());
+	StartLocations.Add(Zombie->StartLocation);
+	Distances.Add(MAX_flt);
+	AttackTimers.Add(0.f);
+	CanSeeTarget.Add(Zombie->bCanSeePlayer);
+	IsMoving.Add(false);
+	Tiers.Add(EZombieTier::Near);
+	TimesSinceUpdate.Add(0.f);
+	TierCounts[(uint8)EZombieTier::Near]++;
+
+	Grid.Add(Index, Locations[Index]);
+
+	AttackingDistances.Add(Zombie->AttackingDistance);
+	ChaseDistances.Add(Zombie->ChaseDistance);
+	TimesBetweenAttacks.Add(Zombie->TimeBetweenAttacks);
+	SightRadii.Add(Zombie->SightRadius);
+	SightCosines.Add(FMath::Cos(FMath::DegreesToRadians(Zombie->PeripheralVisionAngle)));
+
+	return Index;
+}
+
+void UHordeSubsystem::UnregisterZombie(AZombieAI* Zombie)
+{
+	const int32 Index = Zombie->HordeIndex;
+	if (!Zombies.IsValidIndex(Index) || Zombies[Index] != Zombie)
+	{
+		return;
+	}
+
+	TierCounts[(uint8)Tiers[Index]]--;
+	Grid.Remove(Index);
+
+	// Swap the last zombie into the free slot so the arrays stay packed
+	Zombies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Targets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	States.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Forwards.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	StartLocations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Distances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AttackTimers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CanSeeTarget.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	IsMoving.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Tiers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TimesSinceUpdate.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AttackingDistances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ChaseDistances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TimesBetweenAttacks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	SightRadii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	SightCosines.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	if (Zombies.IsValidIndex(Index))
+	{
+		Zombies[Index]->HordeIndex = Index;
+		Grid.Reindex(Zombies.Num(), Index);
+	}
+
+	Zombie->HordeIndex = INDEX_NONE;
+}
+
+void UHordeSubsystem::SetState(int32 Index, EEnemyState NewState)
+{
+	States[Index] = NewState;
+	Zombies[Index]->ActiveState = NewState;
+
+	// Alerted zombies wake up straight away
+	if (NewState == EEnemyState::EChaseState)
+	{
+		WakeZombie(Index);
+	}
+}
+
+void UHordeSubsystem::GetZombiesInRadius(const FVector& Center, float Radius, TArray<AZombieAI*>& OutZombies) const
+{
+	TArray<int32> Indices;
+	Grid.QuerySphere(Center, Radius, Locations, Indices);
+
+	for (int32 Index : Indices)
+	{
+		OutZombies.Add(Zombies[Index]);
+	}
+}
+
+void UHordeSubsystem::AlertZombiesInRadius(const FVector& Center, float Radius)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_ZombieAlert);
+
+	TArray<int32> Indices;
+	Grid.QuerySphere(Center, Radius, Locations, Indices);
+
+	for (int32 Index : Indices)
+	{
+		if (States[Index] != EEnemyState::EChaseState)
+		{
+			SetState(Index, EEnemyState::EChaseState);
+		}
+	}
+
+	// Zombies far enough away to be virtual hear it too
+	if (UVirtualHordeSubsystem* VirtualHorde = GetWorld()->GetSubsystem<UVirtualHordeSubsystem>())
+	{
+		VirtualHorde->AlertInRadius(Center, Radius);
+	}
+
+	// Draw alert radius
+	if (CVarDebugHordeAlerts.GetValueOnGameThread())
+	{
+		DrawDebugSphere(GetWorld(), Center, Radius, 12, FColor::Purple, false, 2.f);
+	}
+}
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/ZombieSpatialGrid.h"
+#include "L4D3/Enemy/NearestSurvivorQuery.h"
+#include "HordeSubsystem.generated.h"
+
+// Actions the decision pass asks the game thread to run on a zombie
+enum class EZombieCommand : uint8
+{
+	None = 0,
+	EnterChase = 1 << 0,
+	LoseTarget = 1 << 1,
+	ReturnHome = 1 << 2,
+	Chase = 1 << 3,
+	Stop = 1 << 4,
+	Attack = 1 << 5,
+	Growl = 1 << 6
+};
+ENUM_CLASS_FLAGS(EZombieCommand);
+
+/**
+ * Owns the state of every zombie in the world and updates all of them in one loop per frame.
+ * Zombies don't tick themselves, the subsystem only calls back into them when they have to act.
+ */
+UCLASS()
+class L4D3_API UHordeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Registration
+	int32 RegisterZombie(AZombieAI* Zombie);
+	void UnregisterZombie(AZombieAI* Zombie);
+
+	int32 NumZombies() const { return Zombies.Num(); }
+	AZombieAI* GetZombie(int32 Index) const { return Zombies[Index]; }
+
+	// State
+	EEnemyState GetState(int32 Index) const { return States[Index]; }
+	void SetState(int32 Index, EEnemyState NewState);
+
+	float GetDistanceFromTarget(int32 Index) const { return Distances[Index]; }
+	float GetTimeSinceLastAttack(int32 Index) const { return AttackTimers[Index]; }
+
+	void SetCanSeeTarget(int32 Index, bool bCanSee) { CanSeeTarget[Index] = bCanSee; }
+	bool GetCanSeeTarget(int32 Index) const { return CanSeeTarget[Index]; }
+	void SetTarget(int32 Index, APlayerCharacter* NewTarget) { Targets[Index] = NewTarget; }
+	void SetIsMoving(int32 Index, bool bMoving) { IsMoving[Index] = bMoving; }
+	void SetStartLocation(int32 Index, const FVector& StartLocation) { StartLocations[Index] = StartLocation; }
+
+	// Cached transform, refreshed whenever the zombie is updated
+	const FVector& GetLocation(int32 Index) const { return Locations[Index]; }
+	const FVector& GetForward(int32 Index) const { return Forwards[Index]; }
+
+	// Sight
+	float GetSightRadius(int32 Index) const { return SightRadii[Index]; }
+	float GetSightCosine(int32 Index) const { return SightCosines[Index]; }
+
+	// Significance
+	EZombieTier GetTier(int32 Index) const { return Tiers[Index]; }
+	int32 GetTierCount(EZombieTier Tier) const { return TierCounts[(uint8)Tier]; }
+	void WakeZombie(int32 Index);
+
+	// Queries
+	void GetZombiesInRadius(const FVector& Center, float Radius, TArray<AZombieAI*>& OutZombies) const;
+	void AlertZombiesInRadius(const FVector& Center, float Radius);
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	// Update
+	void RefreshZombie(int32 Index);
+
+	// Targeting
+	void GatherSurvivors();
+	void RetargetZombie(int32 Index, int32 QueryIndex);
+
+	// Decides what a zombie does this update. Only touches the zombie's own slots so it is safe to run on worker threads
+	EZombieCommand DecideZombie(int32 Index, float DeltaTime, float ReturnHomeToleranceSquared);
+
+	// Direction away from neighbouring zombies, 0 to 1 strength. Read only, safe on worker threads
+	FVector ComputeSeparation(int32 Index, float Radius) const;
+
+	// Runs the decided actions on the zombie, game thread only
+	void ApplyCommands(int32 Index, EZombieCommand Commands);
+
+	// Significance
+	void UpdateTier(int32 Index);
+	void SetTier(int32 Index, EZombieTier NewTier);
+
+	// Packed zombie data, every array is indexed by the zombie's HordeIndex
+	UPROPERTY()
+	TArray<AZombieAI*> Zombies;
+	UPROPERTY()
+	TArray<APlayerCharacter*> Targets;
+
+	TArray<EEnemyState> States;
+	TArray<FVector> Locations;
+	TArray<FVector> Forwards;
+	TArray<FVector> StartLocations;
+	TArray<float> Distances;
+	TArray<float> AttackTimers;
+	TArray<bool> CanSeeTarget;
+	TArray<bool> IsMoving;
+	TArray<EZombieTier> Tiers;
+	TArray<float> TimesSinceUpdate;
+
+	// Tuning copied from the zombie when it registers
+	TArray<float> AttackingDistances;
+	TArray<float> ChaseDistances;
+	TArray<float> TimesBetweenAttacks;
+	TArray<float> SightRadii;
+	TArray<float> SightCosines;
+
+	// Zombies updated this frame, with their elapsed time and decided commands
+	TArray<int32> UpdateIndices;
+	TArray<float> UpdateDeltas;
+	TArray<EZombieCommand> UpdateCommands;
+	TArray<FVector> UpdateSeparations;
+
+	// Targeting, zombies are matched to survivors in one batch per frame
+	UPROPERTY()
+	TArray<APlayerCharacter*> Survivors;
+	TArray<int32> TargetIndices;
+	FNearestSurvivorQuery NearestSurvivors;
+
+	// Spatial lookup of Locations
+	FZombieSpatialGrid Grid;
+
+	// Significance
+	int32 TierCounts[3] = {};
+	float TimeSinceDormantCheck;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/NavFlowField.h"
+
+void FNavFlowField::Reset(NavNodeRef InGoalPoly, const FVector& InGoalLocation)
+{
+	GoalPoly = InGoalPoly;
+
+	Costs.Reset();
+	Centers.Reset();
+	Portals.Reset();
+	Frontier.Reset();
+
+	if (GoalPoly != INVALID_NAVNODEREF)
+	{
+		Costs.Add(GoalPoly, 0.f);
+		Centers.Add(GoalPoly, InGoalLocation);
+		Frontier.HeapPush({ GoalPoly, 0.f });
+	}
+}
+
+bool FNavFlowField::Expand(const ARecastNavMesh& NavMesh, int32 MaxExpansions, float MaxCost)
+{
+	for (int32 Expansion = 0; Expansion < MaxExpansions && !Frontier.IsEmpty(); Expansion++)
+	{
+		FFrontierNode Node;
+		Frontier.HeapPop(Node, EAllowShrinking::No);
+
+		// Skip stale heap entries
+		if (Node.Cost > Costs.FindChecked(Node.Poly))
+		{
+			continue;
+		}
+
+		const FVector Center = Centers.FindChecked(Node.Poly);
+
+		Edges.Reset();
+		NavMesh.GetPolyNeighbors(Node.Poly, Edges);
+
+		for (const FNavigationPortalEdge& Edge : Edges)
+		{
+			const FVector Portal = Edge.GetMiddlePoint();
+
+			FVector NeighborCenter;
+			if (!NavMesh.GetPolyCenter(Edge.ToRef, NeighborCenter))
+			{
+				continue;
+			}
+
+			const float Cost = Node.Cost + FVector::Dist(Center, Portal) + FVector::Dist(Portal, NeighborCenter);
+			if (Cost > MaxCost)
+			{
+				continue;
+			}
+
+			const float* OldCost = Costs.Find(Edge.ToRef);
+			if (!OldCost || Cost < *OldCost)
+			{
+				Costs.Add(Edge.ToRef, Cost);
+				Centers.Add(Edge.ToRef, NeighborCenter);
+				Portals.Add(Edge.ToRef, { Edge.Left, Edge.Right, Center });
+				Frontier.HeapPush({ Edge.ToRef, Cost });
+			}
+		}
+	}
+
+	return IsComplete();
+}
+
+bool FNavFlowField::GetWaypoint(NavNodeRef Poly, const FVector& Location, float AgentRadius, FVector& OutWaypoint) const
+{
+	const FPortal* Portal = Portals.Find(Poly);
+	if (!Portal)
+	{
+		return false;
+	}
+
+	// Closest point on the portal, kept an agent radius in from both ends so the zombie doesn't clip a corner
+	const FVector Along = Portal->Right - Portal->Left;
+	const float Length = Along.Size2D();
+	FVector Crossing = (Portal->Left + Portal->Right) * 0.5f;
+	if (Length > AgentRadius * 2.f)
+	{
+		const FVector Inset = Along / Length * AgentRadius;
+		Crossing = FMath::ClosestPointOnSegment(Location, Portal->Left + Inset, Portal->Right - Inset);
+	}
+
+	// Step an agent radius across so reaching the waypoint means the zombie is on the next poly
+	FVector Across = FVector(-Along.Y, Along.X, 0.f).GetSafeNormal();
+	if ((Across | (Portal->Next - Crossing)) < 0.f)
+	{
+		Across = -Across;
+	}
+
+	OutWaypoint = Crossing + Across * AgentRadius;
+	return true;
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavMesh/RecastNavMesh.h"
+
+/**
+ * Distance field over navmesh polys toward one goal. Built with Dijkstra from the goal poly,
+ * a bounded number of polys at a time, then sampled by any number of zombies for the portal
+ * that leads one poly closer to the goal.
+ */
+class L4D3_API FNavFlowField
+{
+public:
+
+	// Starts a new field toward GoalLocation
+	void Reset(NavNodeRef InGoalPoly, const FVector& InGoalLocation);
+
+	// Expands up to MaxExpansions polys, returns true once the field is complete
+	bool Expand(const ARecastNavMesh& NavMesh, int32 MaxExpansions, float MaxCost);
+
+	bool IsComplete() const { return Frontier.IsEmpty(); }
+	bool IsValid() const { return GoalPoly != INVALID_NAVNODEREF; }
+	NavNodeRef GetGoalPoly() const { return GoalPoly; }
+	int32 NumPolys() const { return Costs.Num(); }
+
+	// Point just past the portal leading from Poly toward the goal. Polys are convex, so walking straight
+	// from Location to it never leaves Poly except through that portal. AgentRadius keeps it off the portal's ends
+	bool GetWaypoint(NavNodeRef Poly, const FVector& Location, float AgentRadius, FVector& OutWaypoint) const;
+
+private:
+
+	struct FPortal
+	{
+		FVector Left;
+		FVector Right;
+
+		// Center of the poly on the far side
+		FVector Next;
+	};
+
+	struct FFrontierNode
+	{
+		NavNodeRef Poly;
+		float Cost;
+
+		bool operator<(const FFrontierNode& Other) const { return Cost < Other.Cost; }
+	};
+
+	NavNodeRef GoalPoly = INVALID_NAVNODEREF;
+
+	// Per poly data, keyed by poly
+	TMap<NavNodeRef, float> Costs;
+	TMap<NavNodeRef, FVector> Centers;
+	TMap<NavNodeRef, FPortal> Portals;
+
+	// Min heap of polys left to expand
+	TArray<FFrontierNode> Frontier;
+	TArray<FNavigationPortalEdge> Edges;
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/NearestSurvivorQuery.h"
+
+void FNearestSurvivorQuery::Reset()
+{
+	ZombieCount = 0;
+	ZombieX.Reset();
+	ZombieY.Reset();
+	ZombieZ.Reset();
+	SurvivorX.Reset();
+	SurvivorY.Reset();
+	SurvivorZ.Reset();
+}
+
+void FNearestSurvivorQuery::AddZombie(const FVector& Location)
+{
+	ZombieCount++;
+	ZombieX.Add(Location.X);
+	ZombieY.Add(Location.Y);
+	ZombieZ.Add(Location.Z);
+}
+
+void FNearestSurvivorQuery::AddSurvivor(const FVector& Location)
+{
+	SurvivorX.Add(Location.X);
+	SurvivorY.Add(Location.Y);
+	SurvivorZ.Add(Location.Z);
+}
+
+void FNearestSurvivorQuery::Run()
+{
+	// Pad with zombies at the origin, their results are never read
+	while (ZombieX.Num() % 4 != 0)
+	{
+		ZombieX.Add(0.f);
+		ZombieY.Add(0.f);
+		ZombieZ.Add(0.f);
+	}
+
+	NearestIndices.SetNumUninitialized(ZombieX.Num());
+	NearestDistancesSquared.SetNumUninitialized(ZombieX.Num());
+
+	const int32 NumSurvivorsToCheck = SurvivorX.Num();
+	if (NumSurvivorsToCheck == 0)
+	{
+		return;
+	}
+
+	// Four zombies per iteration, every survivor checked while the best result stays in registers
+	for (int32 i = 0; i < ZombieX.Num(); i += 4)
+	{
+		const VectorRegister4Float X = VectorLoad(&ZombieX[i]);
+		const VectorRegister4Float Y = VectorLoad(&ZombieY[i]);
+		const VectorRegister4Float Z = VectorLoad(&ZombieZ[i]);
+
+		VectorRegister4Float BestDistSquared = VectorSetFloat1(MAX_flt);
+		VectorRegister4Float BestIndex = VectorZeroFloat();
+
+		for (int32 Survivor = 0; Survivor < NumSurvivorsToCheck; Survivor++)
+		{
+			const VectorRegister4Float DeltaX = VectorSubtract(VectorSetFloat1(SurvivorX[Survivor]), X);
+			const VectorRegister4Float DeltaY = VectorSubtract(VectorSetFloat1(SurvivorY[Survivor]), Y);
+			const VectorRegister4Float DeltaZ = VectorSubtract(VectorSetFloat1(SurvivorZ[Survivor]), Z);
+			const VectorRegister4Float DistSquared = VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaZ, DeltaZ)));
+
+			// Keep the closer survivor in each lane
+			const VectorRegister4Float IsCloser = VectorCompareLT(DistSquared, BestDistSquared);
+			BestDistSquared = VectorSelect(IsCloser, DistSquared, BestDistSquared);
+			BestIndex = VectorSelect(IsCloser, VectorSetFloat1((float)Survivor), BestIndex);
+		}
+
+		VectorStore(BestDistSquared, &NearestDistancesSquared[i]);
+		VectorStore(BestIndex, &NearestIndices[i]);
+	}
+}
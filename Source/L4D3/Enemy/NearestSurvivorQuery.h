@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Finds the nearest survivor for a whole batch of zombies at once. Zombie positions are kept as
+ * padded float arrays so four zombies are compared per SIMD instruction, using squared distances only.
+ */
+class L4D3_API FNearestSurvivorQuery
+{
+public:
+
+	// Entries
+	void Reset();
+	void AddZombie(const FVector& Location);
+	void AddSurvivor(const FVector& Location);
+
+	// Runs the kernel, results are indexed in the order zombies were added
+	void Run();
+
+	int32 NumZombies() const { return ZombieCount; }
+	int32 NumSurvivors() const { return SurvivorX.Num(); }
+
+	// Results, only valid after Run and when there is at least one survivor
+	int32 GetNearest(int32 ZombieIndex) const { return (int32)NearestIndices[ZombieIndex]; }
+	float GetDistanceSquared(int32 ZombieIndex) const { return NearestDistancesSquared[ZombieIndex]; }
+
+private:
+
+	int32 ZombieCount = 0;
+
+	// Zombies, padded to a multiple of 4
+	TArray<float> ZombieX;
+	TArray<float> ZombieY;
+	TArray<float> ZombieZ;
+
+	TArray<float> SurvivorX;
+	TArray<float> SurvivorY;
+	TArray<float> SurvivorZ;
+
+	// Survivor indices are stored as floats so they can be selected in the same registers as the distances
+	TArray<float> NearestIndices;
+	TArray<float> NearestDistancesSquared;
+};
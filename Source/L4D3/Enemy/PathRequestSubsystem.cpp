@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/PathRequestSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "NavigationSystem.h"
+
+static TAutoConsoleVariable<bool> CVarShowPathStats(
+	TEXT("l4d3.Path.ShowStats"),
+	false,
+	TEXT("Print the zombie path request queue on screen."));
+
+static FAutoConsoleCommandWithWorld PathStatsCommand(
+	TEXT("l4d3.Path.Stats"),
+	TEXT("Log zombie path request queue depth, latency and cache use."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UPathRequestSubsystem* PathRequests = World->GetSubsystem<UPathRequestSubsystem>())
+		{
+			PathRequests->LogStats();
+		}
+	}));
+
+void UPathRequestSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	const int32 MaxRequests = GetDefault<UL4D3Settings>()->MaxPathRequestsPerFrame;
+	const double Now = FPlatformTime::Seconds();
+
+	ServedThisFrame = 0;
+	int32 Consumed = 0;
+	while (Consumed < Queue.Num() && ServedThisFrame < MaxRequests)
+	{
+		const FQueuedPathRequest Entry = Queue[Consumed++];
+		if (!IsQueued(Entry))
+		{
+			// Cancelled, replaced or already served
+			continue;
+		}
+
+		FPendingPathRequest Request;
+		Pending.RemoveAndCopyValue(Entry.Zombie, Request);
+
+		AZombieAI* Zombie = Entry.Zombie.Get();
+		if (!IsValid(Zombie))
+		{
+			continue;
+		}
+
+		switch (Request.Type)
+		{
+		case EZombiePathRequest::ReturnHome:
+			ServeReturnHome(Zombie);
+			break;
+		case EZombiePathRequest::Chase:
+			Zombie->MoveToTarget();
+			break;
+		}
+
+		// Stats
+		const double Latency = Now - Request.QueuedTime;
+		TotalLatencySeconds += Latency;
+		MaxLatencySeconds = FMath::Max(MaxLatencySeconds, Latency);
+		ServedCount++;
+		ServedThisFrame++;
+	}
+
+	Queue.RemoveAt(0, Consumed, EAllowShrinking::No);
+
+	// Cancelled requests and destroyed zombies leave stale entries behind, drop them once they outnumber the live ones
+	if (Queue.Num() > Pending.Num() * 2 + MaxRequests)
+	{
+		Queue.RemoveAll([this](const FQueuedPathRequest& Entry) { return !IsQueued(Entry); });
+	}
+
+	// Print stats
+	if (CVarShowPathStats.GetValueOnGameThread())
+	{
+		GEngine->AddOnScreenDebugMessage((uint64)(UPTRINT)this, 0.f, FColor::Cyan, FString::Printf(TEXT("Paths: %d queued, %d served, %.1f ms average latency"),
+			Pending.Num(), ServedThisFrame, GetAverageLatencyMs()));
+	}
+}
+
+TStatId UPathRequestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPathRequestSubsystem, STATGROUP_Tickables);
+}
+
+bool UPathRequestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPathRequestSubsystem::RequestMove(AZombieAI* Zombie, EZombiePathRequest Type)
+{
+	// Keep the queue position and latency of a request that is already waiting
+	if (FPendingPathRequest* Existing = Pending.Find(Zombie))
+	{
+		Existing->Type = Type;
+		DedupedCount++;
+		return;
+	}
+
+	FPendingPathRequest Request;
+	Request.Type = Type;
+	Request.QueuedTime = FPlatformTime::Seconds();
+	Request.Serial = ++NextSerial;
+
+	Pending.Add(Zombie, Request);
+	Queue.Add({ Zombie, Request.Serial });
+}
+
+void UPathRequestSubsystem::CancelRequest(AZombieAI* Zombie)
+{
+	Pending.Remove(Zombie);
+}
+
+void UPathRequestSubsystem::ForgetZombie(AZombieAI* Zombie)
+{
+	Pending.Remove(Zombie);
+	HomePaths.Remove(Zombie);
+}
+
+bool UPathRequestSubsystem::IsHomeUnreachable(const AZombieAI* Zombie) const
+{
+	const FCachedHomePath* Cached = HomePaths.Find(const_cast<AZombieAI*>(Zombie));
+	return Cached && GetWorld()->GetTimeSeconds() < Cached->RetryTime;
+}
+
+bool UPathRequestSubsystem::IsQueued(const FQueuedPathRequest& Entry) const
+{
+	const FPendingPathRequest* Request = Pending.Find(Entry.Zombie);
+	return Request && Request->Serial == Entry.Serial;
+}
+
+void UPathRequestSubsystem::ServeReturnHome(AZombieAI* Zombie)
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+	const FVector From = Zombie->GetActorLocation();
+	const FVector Home = Zombie->GetStartLocation();
+
+	// Reuse the last path home when the zombie is still near where it started from
+	FCachedHomePath* Cached = HomePaths.Find(Zombie);
+	if (Cached && Cached->Path.IsValid() && Cached->Path->IsValid() && FVector::DistSquared(Cached->From, From) <= FMath::Square(Settings->HomePathCacheTolerance))
+	{
+		CacheHits++;
+		Zombie->FollowPath(Home, Cached->Path);
+		return;
+	}
+
+	CacheMisses++;
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = IsValid(NavSystem) ? NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (!IsValid(NavData))
+	{
+		Zombie->FollowPath(Home, nullptr);
+		return;
+	}
+
+	FPathFindingQuery Query(Zombie, *NavData, From, Home);
+	FPathFindingResult Result = NavSystem->FindPathSync(Query);
+
+	// A failed search is remembered so the zombie stands still for a while instead of searching every frame
+	FCachedHomePath& Entry = HomePaths.FindOrAdd(Zombie);
+	Entry.Path = Result.IsSuccessful() ? Result.Path : nullptr;
+	Entry.From = From;
+	Entry.RetryTime = Result.IsSuccessful() ? 0.0 : GetWorld()->GetTimeSeconds() + Settings->HomePathRetryDelay;
+	if (!Result.IsSuccessful())
+	{
+		FailedCount++;
+	}
+
+	Zombie->FollowPath(Home, Result.IsSuccessful() ? Result.Path : nullptr);
+}
+
+void UPathRequestSubsystem::LogStats() const
+{
+	const int32 CacheRequests = CacheHits + CacheMisses;
+	UE_LOG(LogL4D3, Log, TEXT("Path requests: %d queued, %d served (%d last frame), %d deduped, %.2f ms average latency, %.2f ms max latency, home path cache %d hits / %d misses (%.1f%%), %d failed home paths, %d queue entries"),
+		Pending.Num(), ServedCount, ServedThisFrame, DedupedCount, GetAverageLatencyMs(), MaxLatencySeconds * 1000.0,
+		CacheHits, CacheMisses, CacheRequests > 0 ? 100.0 * CacheHits / CacheRequests : 0.0, FailedCount, Queue.Num());
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationData.h"
+#include "PathRequestSubsystem.generated.h"
+
+class AZombieAI;
+
+enum class EZombiePathRequest : uint8
+{
+	ReturnHome,
+	Chase
+};
+
+struct FPendingPathRequest
+{
+	EZombiePathRequest Type = EZombiePathRequest::ReturnHome;
+	double QueuedTime = 0.0;
+
+	// Matches the request's entry in the queue
+	uint32 Serial = 0;
+};
+
+struct FQueuedPathRequest
+{
+	TWeakObjectPtr<AZombieAI> Zombie;
+	uint32 Serial = 0;
+};
+
+struct FCachedHomePath
+{
+	FNavPathSharedPtr Path;
+	FVector From = FVector::ZeroVector;
+
+	// World time before which a zombie whose last search failed doesn't search again
+	double RetryTime = 0.0;
+};
+
+/**
+ * Queues zombie pathfinding so only a limited number of paths are found per frame.
+ * Each zombie has at most one request queued, and return-home paths are cached per zombie.
+ */
+UCLASS()
+class L4D3_API UPathRequestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Requests, a new request replaces the zombie's queued one
+	void RequestMove(AZombieAI* Zombie, EZombiePathRequest Type);
+	void CancelRequest(AZombieAI* Zombie);
+	void ForgetZombie(AZombieAI* Zombie);
+
+	// True while the zombie's last search for a path home failed recently
+	bool IsHomeUnreachable(const AZombieAI* Zombie) const;
+
+	// Stats
+	int32 GetQueueDepth() const { return Pending.Num(); }
+	double GetAverageLatencyMs() const { return ServedCount > 0 ? TotalLatencySeconds * 1000.0 / ServedCount : 0.0; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void ServeReturnHome(AZombieAI* Zombie);
+	bool IsQueued(const FQueuedPathRequest& Entry) const;
+
+	// Queue order, entries without a pending request of the same serial were cancelled or replaced
+	TArray<FQueuedPathRequest> Queue;
+	TMap<TWeakObjectPtr<AZombieAI>, FPendingPathRequest> Pending;
+	uint32 NextSerial;
+
+	TMap<TWeakObjectPtr<AZombieAI>, FCachedHomePath> HomePaths;
+
+	// Stats
+	int32 ServedThisFrame;
+	int32 ServedCount;
+	int32 DedupedCount;
+	int32 CacheHits;
+	int32 CacheMisses;
+	int32 FailedCount;
+	double TotalLatencySeconds;
+	double MaxLatencySeconds;
+};
@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/VirtualHordeSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "NavigationSystem.h"
+
+static FAutoConsoleCommandWithWorld VirtualHordeStatsCommand(
+	TEXT("l4d3.VirtualHorde.Stats"),
+	TEXT("Log the number of virtual zombies and how many were promoted and demoted."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UVirtualHordeSubsystem* VirtualHorde = World->GetSubsystem<UVirtualHordeSubsystem>())
+		{
+			VirtualHorde->LogStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs VirtualHordeSpawnCommand(
+	TEXT("l4d3.VirtualHorde.Spawn"),
+	TEXT("Add virtual zombies on the navmesh around player 0. Args: count (default 1000), radius (default 20000)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UVirtualHordeSubsystem* VirtualHorde = World->GetSubsystem<UVirtualHordeSubsystem>();
+		APlayerController* PlayerController = World->GetFirstPlayerController();
+		if (IsValid(VirtualHorde) && IsValid(PlayerController) && IsValid(PlayerController->GetPawn()))
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+			const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 20000.f;
+			VirtualHorde->SpawnVirtualZombies(PlayerController->GetPawn()->GetActorLocation(), Radius, Count);
+		}
+	}));
+
+void UVirtualHordeSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	// Virtual zombies don't need to react every frame
+	TimeSinceCheck += DeltaTime;
+	if (TimeSinceCheck < GetDefault<UL4D3Settings>()->VirtualHordeCheckInterval)
+	{
+		return;
+	}
+	const float Elapsed = TimeSinceCheck;
+	TimeSinceCheck = 0.f;
+
+	GatherSurvivors();
+	if (SurvivorLocations.IsEmpty())
+	{
+		return;
+	}
+
+	UpdateVirtualZombies(Elapsed);
+	DemoteDistantZombies();
+}
+
+TStatId UVirtualHordeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVirtualHordeSubsystem, STATGROUP_Tickables);
+}
+
+bool UVirtualHordeSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UVirtualHordeSubsystem::AddVirtualZombie(const FVector& Location, const FVector& StartLocation, EEnemyState State, int32 Health, int32 MeshVariant)
+{
+	Locations.Add(Location);
+	StartLocations.Add(StartLocation);
+	States.Add(State);
+	Healths.Add(Health);
+	MeshVariants.Add(MeshVariant);
+
+	PeakVirtual = FMath::Max(PeakVirtual, Locations.Num());
+
+	return Locations.Num() - 1;
+}
+
+void UVirtualHordeSubsystem::SpawnVirtualZombies(const FVector& Center, float Radius, int32 Count)
+{
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+	if (!IsValid(NavSystem) || !IsValid(Pool) || !Pool->GetZombieClass())
+	{
+		return;
+	}
+
+	const float HalfHeight = Pool->GetZombieClass()->GetDefaultObject<AZombieAI>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	int32 Added = 0;
+	for (int32 i = 0; i < Count; i++)
+	{
+		FNavLocation NavLocation;
+		if (NavSystem->GetRandomPointInNavigableRadius(Center, Radius, NavLocation))
+		{
+			const FVector Location = NavLocation.Location + FVector(0.f, 0.f, HalfHeight);
+			AddVirtualZombie(Location, Location);
+			Added++;
+		}
+	}
+
+	UE_LOG(LogL4D3, Log, TEXT("Virtual horde: added %d of %d zombies, %d virtual"), Added, Count, Locations.Num());
+}
+
+void UVirtualHordeSubsystem::GatherSurvivors()
+{
+	SurvivorLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APlayerCharacter* Survivor = IsValid(PlayerController) ? Cast<APlayerCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (IsValid(Survivor) && !Survivor->IsDead())
+		{
+			SurvivorLocations.Add(Survivor->GetActorLocation());
+		}
+	}
+}
+
+void UVirtualHordeSubsystem::UpdateVirtualZombies(float DeltaTime)
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	// Nearest survivor for every virtual zombie at once
+	NearestSurvivors.Reset();
+	for (const FVector& Location : Locations)
+	{
+		NearestSurvivors.AddZombie(Location);
+	}
+	for (const FVector& Location : SurvivorLocations)
+	{
+		NearestSurvivors.AddSurvivor(Location);
+	}
+	NearestSurvivors.Run();
+
+	const float PromoteDistanceSquared = FMath::Square(Settings->PromoteDistance);
+	const float ChaseStep = Settings->VirtualChaseSpeed * DeltaTime;
+	int32 PromotionsLeft = Settings->MaxPromotionsPerFrame;
+
+	// Backwards, so promoted zombies can be swap removed without skipping any
+	for (int32 Index = Locations.Num() - 1; Index >= 0; Index--)
+	{
+		if (NearestSurvivors.GetDistanceSquared(Index) <= PromoteDistanceSquared)
+		{
+			if (PromotionsLeft > 0 && Promote(Index))
+			{
+				PromotionsLeft--;
+			}
+			continue;
+		}
+
+		// Alerted zombies close in on their survivor
+		if (States[Index] == EEnemyState::EChaseState)
+		{
+			const FVector& Survivor = SurvivorLocations[NearestSurvivors.GetNearest(Index)];
+			const FVector Direction = (Survivor - Locations[Index]).GetSafeNormal2D();
+			Locations[Index] += Direction * ChaseStep;
+		}
+	}
+}
+
+void UVirtualHordeSubsystem::DemoteDistantZombies()
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	UHordeSubsystem* Horde = GetWorld()->GetSubsystem<UHordeSubsystem>();
+	if (!IsValid(Horde))
+	{
+		return;
+	}
+
+	// Nearest survivor for every actor zombie, the horde only knows the distance to each zombie's own target
+	NearestSurvivors.Reset();
+	for (int32 Index = 0; Index < Horde->NumZombies(); Index++)
+	{
+		NearestSurvivors.AddZombie(Horde->GetLocation(Index));
+	}
+	for (const FVector& Location : SurvivorLocations)
+	{
+		NearestSurvivors.AddSurvivor(Location);
+	}
+	NearestSurvivors.Run();
+
+	const float DemoteDistanceSquared = FMath::Square(Settings->DemoteDistance);
+	int32 DemotionsLeft = Settings->MaxDemotionsPerFrame;
+
+	// Backwards, demoted zombies are swap removed from the horde
+	for (int32 Index = Horde->NumZombies() - 1; Index >= 0 && DemotionsLeft > 0; Index--)
+	{
+		AZombieAI* Zombie = Horde->GetZombie(Index);
+		if (Zombie->IsDead() || NearestSurvivors.GetDistanceSquared(Index) <= DemoteDistanceSquared)
+		{
+			continue;
+		}
+
+		Demote(Zombie);
+		DemotionsLeft--;
+	}
+}
+
+void UVirtualHordeSubsystem::Demote(AZombieAI* Zombie)
+{
+	if (!IsValid(Zombie) || Zombie->IsDead())
+	{
+		return;
+	}
+
+	AddVirtualZombie(Zombie->GetActorLocation(), Zombie->StartLocation, Zombie->ActiveState, Zombie->CurrentHealth, Zombie->MeshVariant);
+	Demotions++;
+
+	// Pooled zombies go back to the pool, zombies placed in the level come back from it later
+	if (IsValid(Zombie->Pool))
+	{
+		Zombie->Pool->Release(Zombie);
+	}
+	else
+	{
+		Zombie->Destroy();
+	}
+}
+
+bool UVirtualHordeSubsystem::Promote(int32 Index)
+{
+	UZombiePoolSubsystem* Pool = GetWorld()->GetSubsystem<UZombiePoolSubsystem>();
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!IsValid(Pool) || !Pool->GetZombieClass())
+	{
+		FailedPromotions++;
+		return false;
+	}
+
+	// Chasing virtual zombies move in straight lines, so put them back on the navmesh
+	FVector Location = Locations[Index];
+	FNavLocation NavLocation;
+	if (IsValid(NavSystem) && NavSystem->ProjectPointToNavigation(Location, NavLocation, FVector(200.f, 200.f, 500.f)))
+	{
+		const float HalfHeight = Pool->GetZombieClass()->GetDefaultObject<AZombieAI>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+		Location = NavLocation.Location + FVector(0.f, 0.f, HalfHeight);
+	}
+
+	AZombieAI* Zombie = Pool->Acquire(FTransform(Location));
+	if (!IsValid(Zombie))
+	{
+		FailedPromotions++;
+		return false;
+	}
+
+	Zombie->ApplyVirtualState(Healths[Index], MeshVariants[Index], StartLocations[Index], States[Index] == EEnemyState::EChaseState);
+	Promotions++;
+
+	RemoveVirtualZombie(Index);
+	return true;
+}
+
+void UVirtualHordeSubsystem::RemoveVirtualZombie(int32 Index)
+{
+	Locations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	StartLocations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	States.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Healths.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	MeshVariants.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UVirtualHordeSubsystem::AlertInRadius(const FVector& Center, float Radius)
+{
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (int32 Index = 0; Index < Locations.Num(); Index++)
+	{
+		if (FVector::DistSquared(Center, Locations[Index]) <= RadiusSquared)
+		{
+			States[Index] = EEnemyState::EChaseState;
+		}
+	}
+}
+
+void UVirtualHordeSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Virtual horde: %d virtual (peak %d), %d promoted, %d demoted, %d failed promotions"),
+		Locations.Num(), PeakVirtual, Promotions, Demotions, FailedPromotions);
+}
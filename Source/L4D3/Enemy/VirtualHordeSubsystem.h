@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/NearestSurvivorQuery.h"
+#include "VirtualHordeSubsystem.generated.h"
+
+/**
+ * Zombies far from every survivor, kept as packed data (location, state, health, mesh variant)
+ * instead of actors. They are promoted to pooled AZombieAI actors when a survivor gets within
+ * PromoteDistance, and actors further than DemoteDistance are demoted back, keeping their health,
+ * look and alert state both ways.
+ */
+UCLASS()
+class L4D3_API UVirtualHordeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Virtual zombies, health and mesh variant of INDEX_NONE are rolled when the zombie is promoted
+	int32 AddVirtualZombie(const FVector& Location, const FVector& StartLocation, EEnemyState State = EEnemyState::EIdleState,
+		int32 Health = INDEX_NONE, int32 MeshVariant = INDEX_NONE);
+	void SpawnVirtualZombies(const FVector& Center, float Radius, int32 Count);
+	int32 NumVirtual() const { return Locations.Num(); }
+
+	// Turns an actor zombie into a virtual one
+	void Demote(AZombieAI* Zombie);
+
+	// Alerts virtual zombies, actors are alerted by the horde
+	void AlertInRadius(const FVector& Center, float Radius);
+
+	// Stats
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void GatherSurvivors();
+	void UpdateVirtualZombies(float DeltaTime);
+	void DemoteDistantZombies();
+	bool Promote(int32 Index);
+	void RemoveVirtualZombie(int32 Index);
+
+	// Packed virtual zombie data
+	TArray<FVector> Locations;
+	TArray<FVector> StartLocations;
+	TArray<EEnemyState> States;
+	TArray<int32> Healths;
+	TArray<int32> MeshVariants;
+
+	// Survivors
+	TArray<FVector> SurvivorLocations;
+	FNearestSurvivorQuery NearestSurvivors;
+
+	float TimeSinceCheck;
+
+	// Stats
+	int32 Promotions;
+	int32 Demotions;
+	int32 FailedPromotions;
+	int32 PeakVirtual;
+};
@@ -2,22 +2,51 @@
 
 
 #include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/L4D3.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "L4D3/Enemy/FlowFieldSubsystem.h"
+#include "L4D3/Enemy/PathRequestSubsystem.h"
+#include "L4D3/Enemy/ZombieMovementComponent.h"
+#include "L4D3/Enemy/ZombieMeshComponent.h"
+#include "L4D3/Enemy/ZombieAnimationSubsystem.h"
+#include "L4D3/Enemy/CorpseSubsystem.h"
+#include "L4D3/Audio/SoundSchedulerSubsystem.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Net/L4D3ReplicationGraph.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_CYCLE_STAT(TEXT("Zombie Damage"), STAT_L4D3_ZombieDamage, STATGROUP_L4D3);
+
+static TAutoConsoleVariable<bool> CVarCompactZombieMovement(
+	TEXT("l4d3.Net.CompactZombieMovement"),
+	true,
+	TEXT("Replicate zombies with quantized movement and interpolate on clients instead of using ReplicatedMovement."));
 
 // Sets default values
-AZombieAI::AZombieAI()
+AZombieAI::AZombieAI(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer
+		.SetDefaultSubobjectClass<UZombieMovementComponent>(ACharacter::CharacterMovementComponentName)
+		.SetDefaultSubobjectClass<UZombieMeshComponent>(ACharacter::MeshComponentName))
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Zombies are updated by the horde subsystem instead of ticking themselves, only clients tick to interpolate
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Capsule
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
 
-	// Pawn sensing
-	PawnSensing = CreateDefaultSubobject<UPawnSensingComponent>("PawnSensing");
-	PawnSensing->SetPeripheralVisionAngle(70.f);
+	// Animation, skip bone updates off screen and lower the update rate with distance
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	bUseAnimationSharing = true;
+
+	// Sight
+	SightRadius = 5000.f;
+	PeripheralVisionAngle = 70.f;
 
 	// Attacking
 	AttackDamage = 30.f;
@@ -36,25 +65,75 @@ AZombieAI::AZombieAI()
 
 	// Zombie
 	RadiusToAlert = 500.f;
+
+	// Replication
+	NetAlpha = -1.f;
+	NetUpdateInterval = 0.05f;
+	NetLastUpdateTime = 0.0;
 }
 
 // Called when the game starts or when spawned
 void AZombieAI::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// Animation sharing runs wherever zombies are drawn, servers included when they have a local player
+	if (UZombieAnimationSubsystem* Animation = GetWorld()->GetSubsystem<UZombieAnimationSubsystem>())
+	{
+		Animation->RegisterZombie(this);
+	}
+
+	// Clients only draw the zombie, the server runs it
+	if (!HasAuthority())
+	{
+		NetUpdateInterval = 1.f / FMath::Max(GetDefault<UL4D3Settings>()->ZombieNetUpdateFrequency, 1.f);
+		OnRep_ReplicateMovement();
+		return;
+	}
+
+	// Horde
+	Horde = GetWorld()->GetSubsystem<UHordeSubsystem>();
+	Corpses = GetWorld()->GetSubsystem<UCorpseSubsystem>();
+	FlowField = GetWorld()->GetSubsystem<UFlowFieldSubsystem>();
+	PathRequests = GetWorld()->GetSubsystem<UPathRequestSubsystem>();
+
+	// Pooled zombies wait in the pool until they are handed out
+	if (IsValid(Pool))
+	{
+		AIController = Cast<AAIController>(Controller);
+		DeactivateToPool();
+	}
+	else
+	{
+		ResetZombie();
+	}
+}
+
+void AZombieAI::ResetZombie()
+{
 	// Set AI Controller
+	if (!IsValid(Controller))
+	{
+		SpawnDefaultController();
+	}
 	AIController = Cast<AAIController>(Controller);
 
+	// Movement Bindings
+	if (IsValid(AIController))
+	{
+		AIController->SetActorTickEnabled(true);
+		AIController->ReceiveMoveCompleted.AddUniqueDynamic(this, &AZombieAI::OnMoveCompleted);
+	}
+
 	// State default
 	ActiveState = EEnemyState::EIdleState;
+	bCanSeePlayer = false;
+	bIsDead = false;
+	DeathAnimationIndex = INDEX_NONE;
 
-	// Set player as target
+	// Set player as target until the horde picks the nearest survivor
 	Target = Cast<APlayerCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
 
-	// Pawn Sensing Bindings
-	PawnSensing->OnSeePawn.AddDynamic(this, &AZombieAI::OnSeePawn);
-
 	// Start Location
 	StartLocation = GetActorLocation();
 
@@ -64,151 +143,491 @@ void AZombieAI::BeginPlay()
 	CurrentHealth = MaxHealth * RandHealth;
 
 	// Set mesh
-	int32 RandNum = FMath::RandRange(0, ZombieMeshes.Num() - 1);
-	if (ZombieMeshes.IsValidIndex(RandNum))
+	MeshVariant = FMath::RandRange(0, ZombieMeshes.Num() - 1);
+	if (ZombieMeshes.IsValidIndex(MeshVariant))
 	{
-		GetMesh()->SetSkeletalMesh(ZombieMeshes[RandNum]);
+		GetMesh()->SetSkeletalMesh(ZombieMeshes[MeshVariant].LoadSynchronous());
+	}
+
+	// Collision
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	// Join the horde
+	if (IsValid(Horde))
+	{
+		HordeIndex = Horde->RegisterZombie(this);
 	}
-	
 }
 
-// Called every frame
-void AZombieAI::Tick(float DeltaTime)
+void AZombieAI::ActivateFromPool(const FTransform& SpawnTransform)
 {
-	Super::Tick(DeltaTime);
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
 
-	// Update state
-	UpdateState(DeltaTime);
+	// Death animations switch the mesh away from the anim blueprint
+	GetMesh()->SetLeaderPoseComponent(nullptr);
+	GetMesh()->SetAnimationMode(EAnimationMode::AnimationBlueprint);
 
-	// Update distance between target and self
-	DistanceFromTarget = FVector::Distance(Target->GetActorLocation(), GetActorLocation());
+	// Movement
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	ApplyTier(EZombieTier::Near, 0.f);
 
-	// Update time since last attack
-	TimeSinceLastAttack += DeltaTime;
+	ResetZombie();
 }
 
-void AZombieAI::OnSeePawn(APawn* Pawn)
+void AZombieAI::ApplyVirtualState(int32 Health, int32 Variant, const FVector& InStartLocation, bool bIsAlerted)
 {
-	if (Pawn == UGameplayStatics::GetPlayerPawn(GetWorld(), 0))
+	// Health
+	if (Health > 0)
 	{
-		bCanSeePlayer = true;
+		CurrentHealth = Health;
+	}
+
+	// Mesh
+	if (ZombieMeshes.IsValidIndex(Variant))
+	{
+		MeshVariant = Variant;
+		GetMesh()->SetSkeletalMesh(ZombieMeshes[MeshVariant].LoadSynchronous());
+	}
+
+	// Start Location
+	StartLocation = InStartLocation;
+	if (IsInHorde())
+	{
+		Horde->SetStartLocation(HordeIndex, StartLocation);
+	}
+
+	// State
+	if (bIsAlerted)
+	{
+		Alert();
 	}
 }
 
-void AZombieAI::UpdateState(float DeltaTime)
+void AZombieAI::DeactivateToPool()
 {
-	switch (ActiveState)
+	// Leave the horde
+	if (IsValid(Horde))
 	{
-	case EIdleState:
-		IdleState(DeltaTime);
-		break;
-	case EChaseState:
-		ChaseState(DeltaTime);
-		break;
-	default:
-		SetState(EEnemyState::EIdleState);
-		break;
+		Horde->UnregisterZombie(this);
 	}
 
-	// Print state
-	//GEngine->AddOnScreenDebugMessage(1, 1.f, FColor::Green, FString::Printf(TEXT("Active State: %s"),
-	//	*UEnum::GetValueAsString<EEnemyState>(ActiveState)));
+	// Stop everything
+	if (IsValid(PathRequests))
+	{
+		PathRequests->ForgetZombie(this);
+	}
+	if (IsValid(AIController))
+	{
+		AIController->StopMovement();
+	}
+	GetWorldTimerManager().ClearTimer(DeathTimer);
+	ApplyTier(EZombieTier::Dormant, 0.f);
+	GetCharacterMovement()->DisableMovement();
+
+	// Hide
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
 }
 
-void AZombieAI::IdleState(float DeltaTime)
+void AZombieAI::StopForDeath()
 {
-	if (bCanSeePlayer)
+	// Leave the horde so nothing updates the body anymore
+	if (IsValid(Horde))
 	{
-		// Chase player
-		SetState(EEnemyState::EChaseState);
+		Horde->UnregisterZombie(this);
 	}
-	else
+
+	// Stop AI and movement
+	if (IsValid(PathRequests))
 	{
-		// Player too far, return to start location
-		if (IsValid(AIController) && GetActorLocation() != StartLocation)
+		PathRequests->ForgetZombie(this);
+	}
+	if (IsValid(AIController))
+	{
+		AIController->StopMovement();
+		AIController->SetActorTickEnabled(false);
+		if (IsValid(AIController->GetPathFollowingComponent()))
 		{
-			AIController->MoveToLocation(StartLocation);
+			AIController->GetPathFollowingComponent()->SetComponentTickEnabled(false);
 		}
 	}
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+
+	// The mesh keeps ticking at full rate until the death animation is done
+	GetMesh()->SetComponentTickEnabled(true);
+	GetMesh()->SetComponentTickInterval(0.f);
+
+	// Bodies don't move, clients only need the occasional update
+	UL4D3ReplicationGraph::SetZombieLowFrequency(this, true);
 }
 
-void AZombieAI::ChaseState(float DeltaTime)
+void AZombieAI::OnDeathFinished()
 {
-	if (DistanceFromTarget <= AttackingDistance)
+	// Corpses keep the last pose of the death animation
+	GetMesh()->SetComponentTickEnabled(false);
+
+	if (!IsValid(Corpses) && IsValid(Pool))
 	{
-		// Stop movement
-		AIController->StopMovement();
+		Pool->Release(this);
+	}
+}
 
-		if (TimeSinceLastAttack >= TimeBetweenAttacks)
-		{
-			// Attack
-			Target->Damage(AttackDamage);
+void AZombieAI::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UZombieAnimationSubsystem* Animation = GetWorld()->GetSubsystem<UZombieAnimationSubsystem>())
+	{
+		Animation->UnregisterZombie(this);
+	}
 
-			// Play sound
-			PlayRandomGrowl();
+	// Leave the horde
+	if (IsValid(Horde))
+	{
+		Horde->UnregisterZombie(this);
+	}
 
-			// Reset timer
-			TimeSinceLastAttack = 0;
+	if (IsValid(PathRequests))
+	{
+		PathRequests->ForgetZombie(this);
+	}
 
-			// Play anim
-			UAnimInstance* AnimationInstance = GetMesh()->GetAnimInstance();
-			if (IsValid(AnimationInstance) && IsValid(AttackAnimation))
-			{
-				AnimationInstance->Montage_Play(AttackAnimation);
-				GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Green, "Attacked");
-			}
+	Super::EndPlay(EndPlayReason);
+}
 
-		}
+void AZombieAI::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AZombieAI, NetMovement);
+	DOREPLIFETIME(AZombieAI, MeshVariant);
+	DOREPLIFETIME(AZombieAI, DeathAnimationIndex);
+}
+
+void AZombieAI::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	// Pick the movement path before the engine fills ReplicatedMovement
+	const bool bCompact = CVarCompactZombieMovement.GetValueOnGameThread();
+	if (IsReplicatingMovement() == bCompact)
+	{
+		SetReplicatingMovement(!bCompact);
+	}
+
+	// Unchanged values compare equal and aren't sent
+	if (bCompact)
+	{
+		NetMovement.Set(GetActorLocation(), GetActorRotation().Yaw, (uint8)ActiveState, bIsDead);
+	}
+
+	Super::PreReplication(ChangedPropertyTracker);
+}
+
+void AZombieAI::OnRep_ReplicateMovement()
+{
+	Super::OnRep_ReplicateMovement();
+
+	// Full movement replication runs the movement component, compact movement is interpolated in Tick
+	GetCharacterMovement()->SetComponentTickEnabled(IsReplicatingMovement());
+	SetActorTickEnabled(!IsReplicatingMovement());
+	NetAlpha = -1.f;
+}
+
+void AZombieAI::OnRep_NetMovement()
+{
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+	const FVector NewLocation = NetMovement.GetLocation();
+
+	// Time between updates, smoothed so one late packet doesn't stretch the interpolation
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (NetLastUpdateTime > 0.0)
+	{
+		NetUpdateInterval = FMath::Lerp(NetUpdateInterval, FMath::Clamp((float)(Now - NetLastUpdateTime), 0.02f, 1.f), 0.5f);
+	}
+	NetLastUpdateTime = Now;
+
+	// Snap on the first update and on teleports, like a zombie leaving the pool
+	if (NetAlpha < 0.f || FVector::DistSquared(NetTargetLocation, NewLocation) > FMath::Square(Settings->ZombieNetSnapDistance))
+	{
+		SetActorLocationAndRotation(NewLocation, FRotator(0.f, NetMovement.GetYaw(), 0.f));
+		NetVelocity = FVector::ZeroVector;
+		NetFromLocation = NewLocation;
+		NetFromYaw = NetMovement.GetYaw();
+	}
+	else
+	{
+		NetVelocity = (NewLocation - NetTargetLocation) / NetUpdateInterval;
+		NetFromLocation = GetActorLocation();
+		NetFromYaw = GetActorRotation().Yaw;
+	}
+	NetTargetLocation = NewLocation;
+	NetTargetYaw = NetMovement.GetYaw();
+	NetAlpha = 0.f;
+
+	// State
+	ActiveState = (EEnemyState)NetMovement.GetState();
+	bIsDead = NetMovement.IsDead();
+}
+
+void AZombieAI::OnRep_MeshVariant()
+{
+	if (ZombieMeshes.IsValidIndex(MeshVariant))
+	{
+		GetMesh()->SetSkeletalMesh(ZombieMeshes[MeshVariant].LoadSynchronous());
+	}
+}
+
+void AZombieAI::OnRep_DeathAnimation()
+{
+	// Back from the pool, the anim blueprint takes over again
+	if (DeathAnimationIndex == INDEX_NONE)
+	{
+		bIsDead = false;
+		GetWorldTimerManager().ClearTimer(DeathTimer);
+		GetMesh()->SetComponentTickEnabled(true);
+		GetMesh()->SetAnimationMode(EAnimationMode::AnimationBlueprint);
+		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		return;
+	}
+
+	// Same death as on the server, then keep the last pose like the server's corpse
+	bIsDead = true;
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetMesh()->SetComponentTickInterval(0.f);
+	const float DeathLength = PlayDeathAnimation(DeathAnimationIndex);
+	GetWorldTimerManager().SetTimer(DeathTimer, this, &AZombieAI::OnDeathFinished, FMath::Max(DeathLength, 0.1f));
+}
+
+float AZombieAI::PlayDeathAnimation(int32 Index)
+{
+	GetMesh()->SetLeaderPoseComponent(nullptr);
+
+	UAnimMontage* DeathAnimation = DeathAnimations.IsValidIndex(Index) ? DeathAnimations[Index].LoadSynchronous() : nullptr;
+	if (!IsValid(DeathAnimation))
+	{
+		return 0.f;
 	}
-	else if(DistanceFromTarget <= ChaseDistance)
+
+	GetMesh()->PlayAnimation(DeathAnimation, false);
+	return DeathAnimation->GetPlayLength();
+}
+
+void AZombieAI::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// The server moves zombies itself, and full movement replication is smoothed by the movement component
+	if (HasAuthority() || IsReplicatingMovement() || NetAlpha < 0.f)
 	{
-		// Chase
-		if (IsValid(AIController) && !AIController->IsFollowingAPath())
+		return;
+	}
+
+	// Interpolate towards the latest update, then keep going a little while the next one is late
+	NetAlpha = FMath::Min(NetAlpha + DeltaTime / NetUpdateInterval, 1.25f);
+	const FVector Location = NetAlpha <= 1.f
+		? FMath::Lerp(NetFromLocation, NetTargetLocation, NetAlpha)
+		: NetTargetLocation + NetVelocity * (NetAlpha - 1.f) * NetUpdateInterval;
+	const float Yaw = NetFromYaw + FRotator::NormalizeAxis(NetTargetYaw - NetFromYaw) * FMath::Min(NetAlpha, 1.f);
+	SetActorLocationAndRotation(Location, FRotator(0.f, Yaw, 0.f));
+
+	// Animation reads the speed from the movement component
+	GetCharacterMovement()->Velocity = NetAlpha < 1.25f && !bIsDead ? NetVelocity : FVector::ZeroVector;
+}
+
+void AZombieAI::OnSeePawn(APawn* Pawn)
+{
+	// Chase whichever survivor was seen
+	if (APlayerCharacter* Survivor = Cast<APlayerCharacter>(Pawn))
+	{
+		bCanSeePlayer = true;
+		Target = Survivor;
+
+		if (IsInHorde())
 		{
-			AIController->MoveToActor(Target);
-			PlayRandomGrowl();
+			Horde->SetTarget(HordeIndex, Survivor);
+			Horde->SetCanSeeTarget(HordeIndex, true);
 		}
 	}
-	else
+}
+
+void AZombieAI::OnMoveCompleted(FAIRequestID RequestID, EPathFollowingResult::Type Result)
+{
+	if (IsInHorde())
 	{
-		bCanSeePlayer = false;
-		SetState(EEnemyState::EIdleState);
+		Horde->SetIsMoving(HordeIndex, false);
 	}
 }
 
-void AZombieAI::Damage(int32 Damage)
+void AZombieAI::GetStreamedAssets(TArray<FSoftObjectPath>& OutAssets) const
 {
-	// Subtract health
-	CurrentHealth = FMath::Clamp(CurrentHealth -= Damage, 0, MaxHealth);
+	for (const TSoftObjectPtr<USkeletalMesh>& Mesh : ZombieMeshes)
+	{
+		OutAssets.AddUnique(Mesh.ToSoftObjectPath());
+	}
+	for (const TSoftObjectPtr<UAnimMontage>& Animation : DeathAnimations)
+	{
+		OutAssets.AddUnique(Animation.ToSoftObjectPath());
+	}
+	for (const TSoftObjectPtr<USoundBase>& Sound : GrowlSounds)
+	{
+		OutAssets.AddUnique(Sound.ToSoftObjectPath());
+	}
+}
 
-	// Alert nearby zombies
-	if (ActiveState != EEnemyState::EChaseState)
+UZombieMovementComponent* AZombieAI::GetZombieMovement() const
+{
+	return Cast<UZombieMovementComponent>(GetCharacterMovement());
+}
+
+float AZombieAI::GetDistanceFromTarget() const
+{
+	return IsInHorde() ? Horde->GetDistanceFromTarget(HordeIndex) : MAX_flt;
+}
+
+float AZombieAI::GetTimeSinceLastAttack() const
+{
+	return IsInHorde() ? Horde->GetTimeSinceLastAttack(HordeIndex) : 0.f;
+}
+
+void AZombieAI::SetState(EEnemyState NewState)
+{
+	if (IsInHorde())
 	{
-		// create tarray for hit results
-		TArray<FHitResult> OutHits;
+		Horde->SetState(HordeIndex, NewState);
+	}
+	else
+	{
+		ActiveState = NewState;
+	}
+}
+
+void AZombieAI::ApplyTier(EZombieTier Tier, float MidTickInterval)
+{
+	const bool bIsAwake = Tier != EZombieTier::Dormant;
+	const float TickInterval = Tier == EZombieTier::Mid ? MidTickInterval : 0.f;
+
+	// Movement
+	GetCharacterMovement()->SetComponentTickEnabled(bIsAwake);
+	GetCharacterMovement()->SetComponentTickInterval(TickInterval);
 
-		// create a collision sphere
-		FCollisionShape ColSphere = FCollisionShape::MakeSphere(RadiusToAlert);
+	// Animation
+	GetMesh()->SetComponentTickEnabled(bIsAwake);
+	GetMesh()->SetComponentTickInterval(TickInterval);
 
-		// draw collision sphere
-		DrawDebugSphere(GetWorld(), GetActorLocation(), ColSphere.GetSphereRadius(), 50, FColor::Purple, false, 2.f);
+	// Path following
+	if (IsValid(AIController) && IsValid(AIController->GetPathFollowingComponent()))
+	{
+		AIController->GetPathFollowingComponent()->SetComponentTickEnabled(bIsAwake);
+	}
 
-		// check if something got hit in the sweep
-		bool bIsHit = GetWorld()->SweepMultiByChannel(OutHits, GetActorLocation(), GetActorLocation(), FQuat::Identity, ECC_WorldStatic, ColSphere);
+	// Replication
+	UL4D3ReplicationGraph::SetZombieLowFrequency(this, !bIsAwake);
+}
 
-		if (bIsHit)
+void AZombieAI::ReturnToStart()
+{
+	// No path home was found recently, wait where we are
+	if (IsValid(AIController) && IsValid(PathRequests) && !PathRequests->IsHomeUnreachable(this))
+	{
+		PathRequests->RequestMove(this, EZombiePathRequest::ReturnHome);
+		Horde->SetIsMoving(HordeIndex, true);
+	}
+}
+
+void AZombieAI::ChaseTarget()
+{
+	if (IsValid(AIController))
+	{
+		// Walk to the next portal of the target's flow field, or pathfind to the target once close
+		FVector Waypoint;
+		if (IsValid(FlowField) && FlowField->GetChaseWaypoint(Target, GetActorLocation(), GetCapsuleComponent()->GetScaledCapsuleRadius(), Waypoint))
 		{
-			// loop through TArray
-			for (auto& Hit : OutHits)
+			if (IsValid(PathRequests))
 			{
-				AZombieAI* ZombieHit = Cast<AZombieAI>(Hit.GetActor());
-				if(IsValid(ZombieHit))
-				{
-					ZombieHit->SetState(EEnemyState::EChaseState);
-				}
+				PathRequests->CancelRequest(this);
 			}
+
+			const EPathFollowingRequestResult::Type Result = AIController->MoveToLocation(Waypoint, GetDefault<UL4D3Settings>()->FlowFieldAcceptanceRadius, false, false, false);
+			Horde->SetIsMoving(HordeIndex, Result == EPathFollowingRequestResult::RequestSuccessful);
+		}
+		else if (IsValid(PathRequests))
+		{
+			PathRequests->RequestMove(this, EZombiePathRequest::Chase);
+			Horde->SetIsMoving(HordeIndex, true);
+		}
+		else
+		{
+			MoveToTarget();
 		}
 	}
+}
+
+void AZombieAI::MoveToTarget()
+{
+	if (IsValid(AIController) && IsInHorde())
+	{
+		const EPathFollowingRequestResult::Type Result = AIController->MoveToActor(Target);
+		Horde->SetIsMoving(HordeIndex, Result == EPathFollowingRequestResult::RequestSuccessful);
+	}
+}
+
+void AZombieAI::FollowPath(const FVector& Goal, FNavPathSharedPtr Path)
+{
+	if (IsValid(AIController) && IsInHorde())
+	{
+		const bool bIsMoving = Path.IsValid() && AIController->RequestMove(FAIMoveRequest(Goal), Path).IsValid();
+		Horde->SetIsMoving(HordeIndex, bIsMoving);
+	}
+}
+
+void AZombieAI::StopMoving()
+{
+	if (IsValid(PathRequests))
+	{
+		PathRequests->CancelRequest(this);
+	}
+
+	if (IsValid(AIController))
+	{
+		AIController->StopMovement();
+	}
+	Horde->SetIsMoving(HordeIndex, false);
+}
+
+void AZombieAI::Attack()
+{
+	// Attack
+	Target->Damage(AttackDamage);
+
+	// Play anim
+	UAnimInstance* AnimationInstance = GetMesh()->GetAnimInstance();
+	if (IsValid(AnimationInstance) && IsValid(AttackAnimation))
+	{
+		AnimationInstance->Montage_Play(AttackAnimation);
+		GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Green, "Attacked");
+	}
+}
+
+void AZombieAI::Damage(int32 Damage)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_ZombieDamage);
+
+	// Corpses can't be hurt
+	if (bIsDead)
+	{
+		return;
+	}
+
+	// Subtract health
+	CurrentHealth = FMath::Clamp(CurrentHealth -= Damage, 0, MaxHealth);
+
+	// Alert nearby zombies
+	if (ActiveState != EEnemyState::EChaseState && IsValid(Horde))
+	{
+		Horde->AlertZombiesInRadius(GetActorLocation(), RadiusToAlert);
+	}
 
 	// Chase player on hit
 	SetState(EEnemyState::EChaseState);
@@ -219,17 +638,24 @@ void AZombieAI::Damage(int32 Damage)
 		// Play sound
 		PlayRandomGrowl(true);
 
-		// Play anim
-		int8 RandNum = FMath::RandRange(0, DeathAnimations.Num() - 1);
-		if (DeathAnimations.IsValidIndex(RandNum))
-		{
-			GetMesh()->PlayAnimation(DeathAnimations[RandNum], false);
-		}
+		// Play anim, clients play the same one when the index replicates
+		DeathAnimationIndex = (int8)FMath::Clamp(FMath::RandRange(0, DeathAnimations.Num() - 1), INDEX_NONE, MAX_int8);
+		const float DeathLength = PlayDeathAnimation(DeathAnimationIndex);
+
+		// Freeze the body once the animation is done
+		GetWorldTimerManager().SetTimer(DeathTimer, this, &AZombieAI::OnDeathFinished, FMath::Max(DeathLength, 0.1f));
 
 		// Disable collision
 		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 		bIsDead = true;
+		StopForDeath();
+
+		// The corpse manager decides when the body goes back to the pool
+		if (IsValid(Corpses))
+		{
+			Corpses->AddCorpse(this);
+		}
 
 	}
 	else
@@ -243,10 +669,20 @@ void AZombieAI::PlayRandomGrowl(bool IsGuaranteed)
 {
 	if ((FMath::RandRange(0, ChanceToPlaySound) == 0 || IsGuaranteed) && !bIsDead)
 	{
+		// Growls that haven't streamed in yet are skipped rather than loaded on the spot
 		int32 RandNum = FMath::RandRange(0, GrowlSounds.Num() - 1);
-		if (GrowlSounds.IsValidIndex(RandNum))
+		USoundBase* Growl = GrowlSounds.IsValidIndex(RandNum) ? GrowlSounds[RandNum].Get() : nullptr;
+		if (IsValid(Growl))
 		{
-			UGameplayStatics::PlaySoundAtLocation(GetWorld(), GrowlSounds[RandNum], GetActorLocation());
+			// Guaranteed growls (death) win over ambient ones
+			if (USoundSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<USoundSchedulerSubsystem>())
+			{
+				Scheduler->RequestSound(Growl, GetActorLocation(), IsGuaranteed ? ESoundPriority::Normal : ESoundPriority::Low);
+			}
+			else
+			{
+				UGameplayStatics::PlaySoundAtLocation(GetWorld(), Growl, GetActorLocation());
+			}
 		}
 	}
 }
@@ -4,9 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
-#include "Perception/PawnSensingComponent.h"
 #include "AIController.h"
 #include "L4D3/Player/PlayerCharacter.h"
+#include "L4D3/Enemy/ZombieNetMovement.h"
 #include "ZombieAI.generated.h"
 
 UENUM(BlueprintType)
@@ -16,52 +16,156 @@ enum EEnemyState : int8
 	EChaseState
 };
 
+// How often the horde updates a zombie, based on its distance to the target
+enum class EZombieTier : uint8
+{
+	Near,
+	Mid,
+	Dormant
+};
+
 UCLASS()
 class L4D3_API AZombieAI : public ACharacter
 {
 	GENERATED_BODY()
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
-	UPawnSensingComponent* PawnSensing;
+	// The horde subsystem updates zombies and reads their tuning directly
+	friend class UHordeSubsystem;
+	friend class UZombiePoolSubsystem;
+	friend class UZombiePerceptionSubsystem;
+	friend class UVirtualHordeSubsystem;
+	friend class UZombieAnimationSubsystem;
 
 public:
 	// Sets default values for this character's properties
-	AZombieAI();
+	AZombieAI(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
+	// Called when the zombie is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Clients only, interpolates between compact movement updates
 	virtual void Tick(float DeltaTime) override;
 
+	// Replication
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+	virtual void OnRep_ReplicateMovement() override;
+
+	// Resets health, state, mesh and controller and joins the horde
+	void ResetZombie();
+
+	// Pool
+	void ActivateFromPool(const FTransform& SpawnTransform);
+	void DeactivateToPool();
+	void OnDeathFinished();
+
+	// Death, stops AI and movement and leaves the horde
+	void StopForDeath();
+
+	UPROPERTY()
+	class UCorpseSubsystem* Corpses;
+
+	UPROPERTY()
+	class UZombiePoolSubsystem* Pool;
+
+	FTimerHandle DeathTimer;
+
+	// Compact movement, replaces ReplicatedMovement while l4d3.Net.CompactZombieMovement is on
+	UPROPERTY(ReplicatedUsing = OnRep_NetMovement)
+	FZombieNetMovement NetMovement;
+
+	UFUNCTION()
+	void OnRep_NetMovement();
+
+	// Mesh and death animation picked by the server, replicated whichever way movement is
+	UFUNCTION()
+	void OnRep_MeshVariant();
+	UFUNCTION()
+	void OnRep_DeathAnimation();
+	UPROPERTY(ReplicatedUsing = OnRep_DeathAnimation)
+	int8 DeathAnimationIndex = INDEX_NONE;
+
+	// Plays the death montage on the zombie's own pose, returns its length
+	float PlayDeathAnimation(int32 Index);
+
+	// Client interpolation from the previous update to the latest one
+	FVector NetFromLocation;
+	FVector NetTargetLocation;
+	FVector NetVelocity;
+	float NetFromYaw;
+	float NetTargetYaw;
+	float NetAlpha;
+	float NetUpdateInterval;
+	double NetLastUpdateTime;
+
+	// Virtual horde, restores what the zombie carried while it was virtual
+	void ApplyVirtualState(int32 Health, int32 Variant, const FVector& InStartLocation, bool bIsAlerted);
+
 protected:
 
 	// Mesh
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mesh")
-	TArray<USkeletalMesh*> ZombieMeshes;
+	TArray<TSoftObjectPtr<USkeletalMesh>> ZombieMeshes;
+	UPROPERTY(ReplicatedUsing = OnRep_MeshVariant)
+	int32 MeshVariant = INDEX_NONE;
 
-	// Pawn Sensing
-	UFUNCTION()
+	// Animation sharing, locomotion cycles indexed by EZombieAnimState (idle, walk, run)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Animation Sharing")
+	bool bUseAnimationSharing;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Animation Sharing")
+	TArray<UAnimSequenceBase*> SharedAnimations;
+
+	// Sight, checked by the perception subsystem
 	void OnSeePawn(APawn* Pawn);
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sight")
+	float SightRadius;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sight")
+	float PeripheralVisionAngle;
+
 	UPROPERTY(BlueprintReadOnly)
 	bool bCanSeePlayer;
 	UPROPERTY(BlueprintReadOnly)
-	float DistanceFromTarget;
-	UPROPERTY(BlueprintReadOnly)
 	FVector StartLocation;
 
 	AAIController* AIController;
 
+	UFUNCTION()
+	void OnMoveCompleted(FAIRequestID RequestID, EPathFollowingResult::Type Result);
+
+	// Horde
+	UPROPERTY()
+	class UHordeSubsystem* Horde;
+	int32 HordeIndex = INDEX_NONE;
+
+	bool IsInHorde() const { return IsValid(Horde) && HordeIndex != INDEX_NONE; }
+
+	UPROPERTY()
+	class UFlowFieldSubsystem* FlowField;
+	UPROPERTY()
+	class UPathRequestSubsystem* PathRequests;
+
+	UFUNCTION(BlueprintPure)
+	float GetDistanceFromTarget() const;
+	UFUNCTION(BlueprintPure)
+	float GetTimeSinceLastAttack() const;
+
 	// States
-	void UpdateState(float DeltaTime);
-	void SetState(EEnemyState NewState) { ActiveState = NewState; }
+	void SetState(EEnemyState NewState);
 	EEnemyState ActiveState;
 
-	void IdleState(float DeltaTime);
-	void ChaseState(float DeltaTime);
+	// Significance, called by the horde subsystem
+	void ApplyTier(EZombieTier Tier, float MidTickInterval);
+
+	// Actions, called by the horde subsystem
+	void ReturnToStart();
+	void ChaseTarget();
+	void StopMoving();
+	void Attack();
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Zombie")
 	float RadiusToAlert;
@@ -80,8 +184,6 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Attacking")
 	float TimeBetweenAttacks;
 	UPROPERTY(BlueprintReadOnly)
-	float TimeSinceLastAttack;
-	UPROPERTY(BlueprintReadOnly)
 	bool bIsAttacking;
 	UPROPERTY(BlueprintReadOnly)
 	bool bHasDamagedPlayer;
@@ -95,13 +197,13 @@ protected:
 	UPROPERTY(BlueprintReadWrite)
 	int32 CurrentHealth;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health")
-	TArray<UAnimMontage*> DeathAnimations;
+	TArray<TSoftObjectPtr<UAnimMontage>> DeathAnimations;
 
 	// Sound
 	void PlayRandomGrowl(bool IsGuaranteed = false);
 
 	UPROPERTY(EditAnywhere, Category = "Sound")
-	TArray<USoundBase*> GrowlSounds;
+	TArray<TSoftObjectPtr<USoundBase>> GrowlSounds;
 	UPROPERTY(EditAnywhere, Category = "Sound")
 	int32 ChanceToPlaySound;
 
@@ -109,4 +211,21 @@ protected:
 public:
 
 	void Damage(int32 Damage);
+
+	// Moves, called by the path request subsystem once the request is served
+	void MoveToTarget();
+	void FollowPath(const FVector& Goal, FNavPathSharedPtr Path);
+
+	const FVector& GetStartLocation() const { return StartLocation; }
+
+	bool IsDead() const { return bIsDead; }
+	bool IsPooled() const { return IsValid(Pool); }
+
+	// Soft assets every zombie of this class may use, streamed in when the level starts
+	void GetStreamedAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
+	class UZombieMovementComponent* GetZombieMovement() const;
+
+	// Start chasing the target
+	void Alert() { SetState(EEnemyState::EChaseState); }
 };
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombieAnimationSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Enemy/ZombieMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+
+static TAutoConsoleVariable<bool> CVarShowAnimStats(
+	TEXT("l4d3.Anim.ShowStats"),
+	false,
+	TEXT("Print the number of evaluated zombie poses and leader pose followers on screen."));
+
+static FAutoConsoleCommandWithWorld AnimStatsCommand(
+	TEXT("l4d3.Anim.Stats"),
+	TEXT("Log the number of evaluated zombie poses, leader poses and followers."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UZombieAnimationSubsystem* Animation = World->GetSubsystem<UZombieAnimationSubsystem>())
+		{
+			Animation->LogStats();
+		}
+	}));
+
+bool UZombieAnimationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Nothing is drawn on a dedicated server
+	return Super::ShouldCreateSubsystem(Outer) && !IsRunningDedicatedServer();
+}
+
+void UZombieAnimationSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(AI);
+
+	Super::Tick(DeltaTime);
+
+	// Gather local views, split screen has several
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (IsValid(PlayerController) && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			ViewLocations.Add(Location);
+		}
+	}
+
+	if (Zombies.IsEmpty())
+	{
+		NumFollowers = 0;
+		NumEvaluated = Leaders.Num();
+		return;
+	}
+
+	// Update enough zombies this frame to get through all of them once per interval
+	const float Interval = FMath::Max(GetDefault<UL4D3Settings>()->AnimSharingInterval, KINDA_SMALL_NUMBER);
+	const int32 SliceSize = FMath::Min(FMath::CeilToInt32(Zombies.Num() * DeltaTime / Interval), Zombies.Num());
+
+	for (int32 i = 0; i < SliceSize; i++)
+	{
+		if (Cursor >= Zombies.Num())
+		{
+			Cursor = 0;
+		}
+		UpdateZombie(Zombies[Cursor++]);
+	}
+
+	CountInstances();
+
+	// Print stats
+	if (CVarShowAnimStats.GetValueOnGameThread())
+	{
+		GEngine->AddOnScreenDebugMessage((uint64)(UPTRINT)this, 0.f, FColor::Green, FString::Printf(TEXT("Anim: %d evaluated, %d leaders, %d followers"),
+			NumEvaluated, Leaders.Num(), NumFollowers));
+	}
+}
+
+TStatId UZombieAnimationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UZombieAnimationSubsystem, STATGROUP_Tickables);
+}
+
+bool UZombieAnimationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UZombieAnimationSubsystem::RegisterZombie(AZombieAI* Zombie)
+{
+	Zombies.AddUnique(Zombie);
+}
+
+void UZombieAnimationSubsystem::UnregisterZombie(AZombieAI* Zombie)
+{
+	Zombies.RemoveSingleSwap(Zombie, EAllowShrinking::No);
+}
+
+void UZombieAnimationSubsystem::UpdateZombie(AZombieAI* Zombie)
+{
+	USkeletalMeshComponent* Mesh = Zombie->GetMesh();
+
+	// Dead zombies play their death animation themselves, pooled ones aren't drawn
+	if (Zombie->IsDead() || Zombie->IsHidden())
+	{
+		return;
+	}
+
+	// Pick the leader this zombie should follow, if any
+	USkeletalMeshComponent* Leader = nullptr;
+	const EZombieAnimState State = GetAnimState(Zombie);
+	if (State != EZombieAnimState::None && Zombie->bUseAnimationSharing)
+	{
+		UAnimSequenceBase* Animation = Zombie->SharedAnimations.IsValidIndex((uint8)State) ? Zombie->SharedAnimations[(uint8)State] : nullptr;
+		if (IsValid(Animation) && IsValid(Mesh->GetSkeletalMeshAsset()))
+		{
+			Leader = FindOrAddLeader(Mesh->GetSkeletalMeshAsset(), Animation);
+		}
+	}
+
+	if (Mesh->LeaderPoseComponent.Get() != Leader)
+	{
+		Mesh->SetLeaderPoseComponent(Leader);
+		LeaderSwitches++;
+	}
+}
+
+EZombieAnimState UZombieAnimationSubsystem::GetAnimState(const AZombieAI* Zombie) const
+{
+	// Close to a camera, where the shared cycle would show, the zombie needs its own anim blueprint
+	const FVector Location = Zombie->GetActorLocation();
+	const float SharingDistanceSquared = FMath::Square(GetDefault<UL4D3Settings>()->AnimSharingDistance);
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		if (FVector::DistSquared(Location, ViewLocation) < SharingDistanceSquared)
+		{
+			return EZombieAnimState::None;
+		}
+	}
+
+	const float Speed = Zombie->GetVelocity().Size2D();
+	const float MaxSpeed = Zombie->GetCharacterMovement()->GetMaxSpeed();
+
+	if (Speed < 10.f)
+	{
+		return EZombieAnimState::Idle;
+	}
+	return Speed < MaxSpeed * 0.5f ? EZombieAnimState::Walk : EZombieAnimState::Run;
+}
+
+USkeletalMeshComponent* UZombieAnimationSubsystem::FindOrAddLeader(USkeletalMesh* Mesh, UAnimSequenceBase* Animation)
+{
+	const TPair<USkeletalMesh*, UAnimSequenceBase*> Key(Mesh, Animation);
+	if (USkeletalMeshComponent** Leader = Leaders.Find(Key))
+	{
+		return *Leader;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	AActor* LeaderActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+	if (!IsValid(LeaderActor))
+	{
+		return nullptr;
+	}
+
+	// Same component as the zombies so shared poses are timed with theirs
+	UZombieMeshComponent* Leader = NewObject<UZombieMeshComponent>(LeaderActor, TEXT("LeaderMesh"));
+	LeaderActor->SetRootComponent(Leader);
+	Leader->RegisterComponent();
+
+	// Hidden, but always posed so followers have something to copy
+	LeaderActor->SetReplicates(false);
+	LeaderActor->SetActorHiddenInGame(true);
+	LeaderActor->SetActorEnableCollision(false);
+
+	Leader->SetSkeletalMesh(Mesh);
+	Leader->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	Leader->PlayAnimation(Animation, true);
+
+	LeaderActors.Add(LeaderActor);
+	Leaders.Add(Key, Leader);
+
+	return Leader;
+}
+
+void UZombieAnimationSubsystem::CountInstances()
+{
+	NumFollowers = 0;
+	NumEvaluated = Leaders.Num();
+
+	for (const AZombieAI* Zombie : Zombies)
+	{
+		if (Zombie->IsHidden())
+		{
+			continue;
+		}
+
+		const USkeletalMeshComponent* Mesh = Zombie->GetMesh();
+		if (Mesh->LeaderPoseComponent.IsValid())
+		{
+			NumFollowers++;
+		}
+		else if (Mesh->IsComponentTickEnabled() && Mesh->ShouldTickPose())
+		{
+			NumEvaluated++;
+		}
+	}
+}
+
+void UZombieAnimationSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Anim: %d poses evaluated (%d leaders), %d followers, %lld leader switches. Evaluation time is in 'stat L4D3' and the benchmark's Animation bucket"),
+		NumEvaluated, Leaders.Num(), NumFollowers, LeaderSwitches);
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ZombieAnimationSubsystem.generated.h"
+
+class AZombieAI;
+
+// Locomotion shared between zombies that follow a leader pose
+enum class EZombieAnimState : uint8
+{
+	Idle,
+	Walk,
+	Run,
+	None
+};
+
+/**
+ * Shares animation between zombies. Zombies further than AnimSharingDistance from every local view
+ * copy the pose of a hidden leader mesh playing the same variant and locomotion cycle, so only one
+ * pose is evaluated per (mesh, animation) pair. Close, attacking and dead zombies run their own anim
+ * blueprint. Every zombie is reassigned once per AnimSharingInterval. Zombies register themselves on
+ * every machine that draws them, a dedicated server has no subsystem.
+ */
+UCLASS()
+class L4D3_API UZombieAnimationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Zombies
+	void RegisterZombie(AZombieAI* Zombie);
+	void UnregisterZombie(AZombieAI* Zombie);
+
+	// Stats, counted every frame
+	int32 GetNumLeaders() const { return Leaders.Num(); }
+	int32 GetNumFollowers() const { return NumFollowers; }
+	int32 GetNumEvaluated() const { return NumEvaluated; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void UpdateZombie(AZombieAI* Zombie);
+	EZombieAnimState GetAnimState(const AZombieAI* Zombie) const;
+	USkeletalMeshComponent* FindOrAddLeader(USkeletalMesh* Mesh, UAnimSequenceBase* Animation);
+	void CountInstances();
+
+	UPROPERTY()
+	TArray<AZombieAI*> Zombies;
+
+	// Next zombie to update
+	int32 Cursor;
+
+	// Where the local players look from, gathered at the start of the frame
+	TArray<FVector> ViewLocations;
+
+	// Leader meshes, keyed by the mesh variant and animation they play
+	TMap<TPair<USkeletalMesh*, UAnimSequenceBase*>, USkeletalMeshComponent*> Leaders;
+	UPROPERTY()
+	TArray<AActor*> LeaderActors;
+
+	// Stats
+	int32 NumFollowers;
+	int32 NumEvaluated;
+	int64 LeaderSwitches;
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombieMeshComponent.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+
+DECLARE_CYCLE_STAT(TEXT("Zombie Animation"), STAT_L4D3_ZombieAnimation, STATGROUP_L4D3);
+
+static TAutoConsoleVariable<bool> CVarAnimIgnoreVisibility(
+	TEXT("l4d3.Anim.IgnoreVisibility"),
+	false,
+	TEXT("Tick the pose and refresh bones of zombie meshes even when they are not rendered. Used by the benchmark, which runs without a renderer."));
+
+void UZombieMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	L4D3_BENCHMARK_SCOPE(Animation);
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_ZombieAnimation);
+
+	if (CVarAnimIgnoreVisibility.GetValueOnGameThread())
+	{
+		if (!OverriddenTickOption.IsSet())
+		{
+			OverriddenTickOption = VisibilityBasedAnimTickOption;
+			VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		}
+	}
+	else if (OverriddenTickOption.IsSet())
+	{
+		VisibilityBasedAnimTickOption = OverriddenTickOption.GetValue();
+		OverriddenTickOption.Reset();
+	}
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "ZombieMeshComponent.generated.h"
+
+/**
+ * Skeletal mesh for zombies and their shared animation leaders. Times the game thread part of the
+ * animation tick under the Animation benchmark bucket and the "Zombie Animation" cycle stat. With
+ * a.ParallelAnimEvaluation=0 that includes pose evaluation, otherwise evaluation runs on worker threads.
+ * l4d3.Anim.IgnoreVisibility makes off screen zombies evaluate their pose too, so a -nullrhi run
+ * measures the cost of a horde in view.
+ */
+UCLASS()
+class L4D3_API UZombieMeshComponent : public USkeletalMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+
+	// Option to restore once l4d3.Anim.IgnoreVisibility is turned off again
+	TOptional<EVisibilityBasedAnimTickOption> OverriddenTickOption;
+};
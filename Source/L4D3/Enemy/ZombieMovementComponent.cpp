@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombieMovementComponent.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "GameFramework/Character.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UZombieMovementComponent::UZombieMovementComponent()
+{
+	bUseLightweightMovement = true;
+
+	// Nav walking only projects onto the navmesh every few frames
+	bProjectNavMeshWalking = true;
+	NavMeshProjectionInterval = 0.1f;
+}
+
+void UZombieMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	L4D3_BENCHMARK_SCOPE(Movement);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void UZombieMovementComponent::UpdateMovementLOD(float DistanceToSurvivor, const FVector& InSeparation)
+{
+	Separation = InSeparation;
+
+	// Falling, disabled or custom movement is left alone
+	if (MovementMode != MOVE_Walking && MovementMode != MOVE_NavWalking)
+	{
+		return;
+	}
+
+	// A little hysteresis so zombies on the boundary don't flip every update
+	const float FullMovementDistance = GetDefault<UL4D3Settings>()->FullMovementDistance;
+	if (!bUseLightweightMovement || DistanceToSurvivor < FullMovementDistance)
+	{
+		if (MovementMode != MOVE_Walking)
+		{
+			SetMovementMode(MOVE_Walking);
+		}
+	}
+	else if (DistanceToSurvivor > FullMovementDistance * 1.2f && MovementMode != MOVE_NavWalking)
+	{
+		SetMovementMode(MOVE_NavWalking);
+	}
+}
+
+void UZombieMovementComponent::CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration)
+{
+	Super::CalcVelocity(DeltaTime, Friction, bFluid, BrakingDeceleration);
+
+	if (Separation.IsNearlyZero())
+	{
+		return;
+	}
+
+	// Only zombies on the move are pushed, idle and attacking ones would slowly slide apart or off their target
+	float MoveScale = GetMaxAcceleration() > 0.f ? FMath::Min(Acceleration.Size() / GetMaxAcceleration(), 1.f) : 0.f;
+	if (const AAIController* AIController = Cast<AAIController>(CharacterOwner ? CharacterOwner->GetController() : nullptr))
+	{
+		if (AIController->GetMoveStatus() == EPathFollowingStatus::Moving)
+		{
+			MoveScale = 1.f;
+		}
+	}
+	if (MoveScale <= 0.f)
+	{
+		return;
+	}
+
+	// Separation only steers, it never makes the zombie faster than it can walk
+	Velocity += Separation * GetDefault<UL4D3Settings>()->SeparationStrength * MoveScale;
+	Velocity = Velocity.GetClampedToMaxSize2D(GetMaxSpeed());
+}
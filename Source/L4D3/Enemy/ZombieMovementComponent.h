@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ZombieMovementComponent.generated.h"
+
+/**
+ * Character movement for zombies. Away from survivors zombies walk in nav walking mode, projected
+ * onto the navmesh without floor sweeps, and switch to full walking with capsule sweeps once a
+ * survivor is close. Nav walking falls back to walking on its own when the zombie leaves the navmesh.
+ * A separation push from the horde keeps neighbouring zombies from stacking up.
+ */
+UCLASS()
+class L4D3_API UZombieMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UZombieMovementComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Called by the horde each time it updates the zombie
+	void UpdateMovementLOD(float DistanceToSurvivor, const FVector& InSeparation);
+
+	bool IsUsingLightweightMovement() const { return MovementMode == MOVE_NavWalking; }
+
+	// Walk on the navmesh while no survivor is close, turn off to always use full walking
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zombie Movement")
+	bool bUseLightweightMovement;
+
+protected:
+
+	virtual void CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration) override;
+
+private:
+
+	// Push away from neighbouring zombies, scaled by SeparationStrength
+	FVector Separation;
+};
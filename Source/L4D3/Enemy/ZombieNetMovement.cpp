@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombieNetMovement.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "TimerManager.h"
+
+static FAutoConsoleCommandWithWorldAndArgs ZombieBandwidthCommand(
+	TEXT("l4d3.Net.ZombieBandwidth"),
+	TEXT("Measure server upstream per zombie per connection over a few seconds, compare with l4d3.Net.CompactZombieMovement on and off. Server only. Optional arg: seconds."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UNetDriver* NetDriver = World->GetNetDriver();
+		if (!IsValid(NetDriver) || !NetDriver->IsServer())
+		{
+			UE_LOG(LogL4D3, Log, TEXT("Zombie bandwidth needs a listen or dedicated server"));
+			return;
+		}
+
+		const float Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 0.5f) : 5.f;
+		const uint32 StartBytes = NetDriver->OutTotalBytes;
+		const double StartTime = FPlatformTime::Seconds();
+
+		// Sample the zombie count at the end, the horde should be steady during the measurement
+		FTimerHandle Timer;
+		World->GetTimerManager().SetTimer(Timer, FTimerDelegate::CreateWeakLambda(NetDriver, [NetDriver, World, StartBytes, StartTime]()
+		{
+			const double Elapsed = FPlatformTime::Seconds() - StartTime;
+			const double BytesPerSecond = (NetDriver->OutTotalBytes - StartBytes) / Elapsed;
+			const int32 NumConnections = FMath::Max(NetDriver->ClientConnections.Num(), 1);
+
+			const UHordeSubsystem* Horde = World->GetSubsystem<UHordeSubsystem>();
+			const int32 NumZombies = IsValid(Horde) ? Horde->NumZombies() : 0;
+
+			const IConsoleVariable* CompactVar = IConsoleManager::Get().FindConsoleVariable(TEXT("l4d3.Net.CompactZombieMovement"));
+			UE_LOG(LogL4D3, Log, TEXT("Zombie bandwidth (%s movement): %.0f bytes/s out to %d connections, %d zombies, %.1f bytes per zombie per second per connection"),
+				CompactVar && CompactVar->GetBool() ? TEXT("compact") : TEXT("default"), BytesPerSecond, NumConnections, NumZombies,
+				NumZombies > 0 ? BytesPerSecond / NumZombies / NumConnections : 0.0);
+		}), Seconds, false);
+	}));
+
+void FZombieNetMovement::Set(const FVector& Location, float InYaw, uint8 InState, bool bInIsDead)
+{
+	const int32 MaxOffset = (1 << OffsetBits) - 1;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Cell[Axis] = FMath::FloorToInt32(Location[Axis] / CellSize);
+		Offset[Axis] = FMath::Clamp(FMath::RoundToInt32(Location[Axis] - Cell[Axis] * CellSize), 0, MaxOffset);
+	}
+
+	Yaw = (uint8)(FMath::RoundToInt32(FRotator::ClampAxis(InYaw) * (256.f / 360.f)) & 0xFF);
+	Flags = (InState & StateMask) | (bInIsDead ? DeadFlag : 0);
+}
+
+FVector FZombieNetMovement::GetLocation() const
+{
+	return FVector(Cell) * CellSize + FVector(Offset);
+}
+
+bool FZombieNetMovement::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		// Cells are small signed numbers, zigzag them so the packed int stays one byte
+		uint32 ZigZagCell = ((uint32)Cell[Axis] << 1) ^ (uint32)(Cell[Axis] >> 31);
+		Ar.SerializeIntPacked(ZigZagCell);
+
+		uint32 AxisOffset = (uint32)Offset[Axis];
+		Ar.SerializeInt(AxisOffset, 1 << OffsetBits);
+
+		if (Ar.IsLoading())
+		{
+			Cell[Axis] = (int32)(ZigZagCell >> 1) ^ -(int32)(ZigZagCell & 1);
+			Offset[Axis] = (int32)AxisOffset;
+		}
+	}
+
+	Ar << Yaw;
+
+	uint32 PackedFlags = Flags;
+	Ar.SerializeInt(PackedFlags, (uint32)(StateMask | DeadFlag) + 1);
+	if (Ar.IsLoading())
+	{
+		Flags = (uint8)PackedFlags;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ZombieNetMovement.generated.h"
+
+/**
+ * What clients need to draw a zombie, replicated instead of ACharacter's full precision movement.
+ * The location is sent as a grid cell plus a 1 cm offset inside it, rotation as an 8 bit yaw and
+ * the AI state and death flag in 3 bits. Clients interpolate between updates.
+ */
+USTRUCT()
+struct L4D3_API FZombieNetMovement
+{
+	GENERATED_BODY()
+
+	// 2^13 cm, so an offset inside a cell fits in 13 bits at 1 cm
+	static constexpr int32 OffsetBits = 13;
+	static constexpr float CellSize = (float)(1 << OffsetBits);
+
+	void Set(const FVector& Location, float InYaw, uint8 InState, bool bInIsDead);
+
+	FVector GetLocation() const;
+	float GetYaw() const { return Yaw * (360.f / 256.f); }
+	uint8 GetState() const { return Flags & StateMask; }
+	bool IsDead() const { return (Flags & DeadFlag) != 0; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FZombieNetMovement& Other) const
+	{
+		return Cell == Other.Cell && Offset == Other.Offset && Yaw == Other.Yaw && Flags == Other.Flags;
+	}
+
+private:
+
+	// State in the low 2 bits, dead flag above it
+	static constexpr uint8 StateMask = 0x3;
+	static constexpr uint8 DeadFlag = 0x4;
+
+	FIntVector Cell = FIntVector::ZeroValue;
+	FIntVector Offset = FIntVector::ZeroValue;
+	uint8 Yaw = 0;
+	uint8 Flags = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FZombieNetMovement> : public TStructOpsTypeTraitsBase2<FZombieNetMovement>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombiePerceptionSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/HordeSubsystem.h"
+#include "L4D3/Player/PlayerCharacter.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sight Traces"), STAT_L4D3_SightTraces, STATGROUP_L4D3);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight Trace Count"), STAT_L4D3_SightTraceCount, STATGROUP_L4D3);
+
+static FAutoConsoleCommandWithWorld PerceptionStatsCommand(
+	TEXT("l4d3.Perception.Stats"),
+	TEXT("Log how many zombie sight checks were culled, traced and skipped."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UZombiePerceptionSubsystem* Perception = World->GetSubsystem<UZombiePerceptionSubsystem>())
+		{
+			Perception->LogStats();
+		}
+	}));
+
+void UZombiePerceptionSubsystem::Tick(float DeltaTime)
+{
+	L4D3_BENCHMARK_SCOPE(Traces);
+
+	Super::Tick(DeltaTime);
+
+	UHordeSubsystem* Horde = GetWorld()->GetSubsystem<UHordeSubsystem>();
+	if (!IsValid(Horde) || Horde->NumZombies() == 0)
+	{
+		return;
+	}
+
+	GatherSurvivors();
+	if (Survivors.IsEmpty())
+	{
+		return;
+	}
+
+	// Check enough zombies this frame to get through the horde once per interval
+	const float SightInterval = FMath::Max(GetDefault<UL4D3Settings>()->SightInterval, KINDA_SMALL_NUMBER);
+	const int32 SliceSize = FMath::Min(FMath::CeilToInt32(Horde->NumZombies() * DeltaTime / SightInterval), Horde->NumZombies());
+
+	GatherSlice(*Horde, SliceSize);
+	CullSlice();
+	TraceCandidates(*Horde);
+}
+
+TStatId UZombiePerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UZombiePerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UZombiePerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UZombiePerceptionSubsystem::GatherSurvivors()
+{
+	Survivors.Reset();
+	SurvivorEyes.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APlayerCharacter* Survivor = IsValid(PlayerController) ? Cast<APlayerCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (IsValid(Survivor))
+		{
+			Survivors.Add(Survivor);
+			SurvivorEyes.Add(Survivor->GetPawnViewLocation());
+		}
+	}
+}
+
+void UZombiePerceptionSubsystem::GatherSlice(const UHordeSubsystem& Horde, int32 Count)
+{
+	SliceIndices.Reset();
+	ZombieX.Reset();
+	ZombieY.Reset();
+	ZombieZ.Reset();
+	ForwardX.Reset();
+	ForwardY.Reset();
+	ForwardZ.Reset();
+	RadiusSquared.Reset();
+	CosineSquared.Reset();
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		if (Cursor >= Horde.NumZombies())
+		{
+			Cursor = 0;
+		}
+		const int32 Index = Cursor++;
+
+		// Dormant zombies are blind, zombies that already see a survivor don't need to look
+		if (Horde.GetTier(Index) == EZombieTier::Dormant || Horde.GetCanSeeTarget(Index) || Horde.GetZombie(Index)->IsDead())
+		{
+			continue;
+		}
+
+		const FVector& Location = Horde.GetLocation(Index);
+		const FVector& Forward = Horde.GetForward(Index);
+
+		SliceIndices.Add(Index);
+		ZombieX.Add(Location.X);
+		ZombieY.Add(Location.Y);
+		ZombieZ.Add(Location.Z);
+		ForwardX.Add(Forward.X);
+		ForwardY.Add(Forward.Y);
+		ForwardZ.Add(Forward.Z);
+		RadiusSquared.Add(FMath::Square(Horde.GetSightRadius(Index)));
+		CosineSquared.Add(FMath::Square(FMath::Max(Horde.GetSightCosine(Index), 0.f)));
+	}
+
+	// Pad with zombies that can't see anything
+	while (ZombieX.Num() % 4 != 0)
+	{
+		ZombieX.Add(0.f);
+		ZombieY.Add(0.f);
+		ZombieZ.Add(0.f);
+		ForwardX.Add(0.f);
+		ForwardY.Add(0.f);
+		ForwardZ.Add(0.f);
+		RadiusSquared.Add(-1.f);
+		CosineSquared.Add(0.f);
+	}
+}
+
+void UZombiePerceptionSubsystem::CullSlice()
+{
+	Candidates.Reset();
+
+	const int32 NumZombies = SliceIndices.Num();
+	const VectorRegister4Float Zero = VectorZeroFloat();
+
+	for (int32 SurvivorIndex = 0; SurvivorIndex < Survivors.Num(); SurvivorIndex++)
+	{
+		const VectorRegister4Float SurvivorX = VectorSetFloat1((float)SurvivorEyes[SurvivorIndex].X);
+		const VectorRegister4Float SurvivorY = VectorSetFloat1((float)SurvivorEyes[SurvivorIndex].Y);
+		const VectorRegister4Float SurvivorZ = VectorSetFloat1((float)SurvivorEyes[SurvivorIndex].Z);
+
+		// Four zombies per iteration
+		for (int32 i = 0; i < NumZombies; i += 4)
+		{
+			const VectorRegister4Float DeltaX = VectorSubtract(SurvivorX, VectorLoad(&ZombieX[i]));
+			const VectorRegister4Float DeltaY = VectorSubtract(SurvivorY, VectorLoad(&ZombieY[i]));
+			const VectorRegister4Float DeltaZ = VectorSubtract(SurvivorZ, VectorLoad(&ZombieZ[i]));
+
+			const VectorRegister4Float DistSquared = VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaZ, DeltaZ)));
+			const VectorRegister4Float Dot = VectorMultiplyAdd(VectorLoad(&ForwardX[i]), DeltaX,
+				VectorMultiplyAdd(VectorLoad(&ForwardY[i]), DeltaY, VectorMultiply(VectorLoad(&ForwardZ[i]), DeltaZ)));
+
+			// In range, in front, and Dot >= Cos * Dist without the square root (peripheral angles up to 90 degrees)
+			const VectorRegister4Float InRange = VectorCompareLE(DistSquared, VectorLoad(&RadiusSquared[i]));
+			const VectorRegister4Float InFront = VectorCompareGE(Dot, Zero);
+			const VectorRegister4Float InCone = VectorCompareGE(VectorMultiply(Dot, Dot), VectorMultiply(VectorLoad(&CosineSquared[i]), DistSquared));
+
+			const int32 Mask = VectorMaskBits(VectorBitwiseAnd(InRange, VectorBitwiseAnd(InFront, InCone)));
+			if (Mask == 0)
+			{
+				continue;
+			}
+
+			alignas(16) float Distances[4];
+			VectorStoreAligned(DistSquared, Distances);
+
+			for (int32 Lane = 0; Lane < 4 && i + Lane < NumZombies; Lane++)
+			{
+				if (Mask & (1 << Lane))
+				{
+					Candidates.Add({ SliceIndices[i + Lane], SurvivorIndex, Distances[Lane] });
+				}
+			}
+		}
+	}
+
+	PairsChecked += (int64)NumZombies * Survivors.Num();
+	PairsCulled += (int64)NumZombies * Survivors.Num() - Candidates.Num();
+}
+
+void UZombiePerceptionSubsystem::TraceCandidates(UHordeSubsystem& Horde)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_SightTraces);
+
+	// Closest first
+	Candidates.Sort([](const FSightCandidate& A, const FSightCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+
+	const int32 MaxTraces = GetDefault<UL4D3Settings>()->MaxSightTracesPerFrame;
+	int32 Traces = 0;
+
+	for (const FSightCandidate& Candidate : Candidates)
+	{
+		// Over budget, or the zombie already saw a closer survivor
+		if (Traces >= MaxTraces || Horde.GetCanSeeTarget(Candidate.ZombieIndex))
+		{
+			TracesSkipped++;
+			continue;
+		}
+
+		AZombieAI* Zombie = Horde.GetZombie(Candidate.ZombieIndex);
+		APlayerCharacter* Survivor = Survivors[Candidate.SurvivorIndex];
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(ZombieSight), true);
+		Params.AddIgnoredActor(Zombie);
+		Params.AddIgnoredActor(Survivor);
+
+		Traces++;
+		if (!GetWorld()->LineTraceTestByChannel(Zombie->GetPawnViewLocation(), SurvivorEyes[Candidate.SurvivorIndex], ECC_Visibility, Params))
+		{
+			Zombie->OnSeePawn(Survivor);
+			Sightings++;
+		}
+	}
+
+	TracesDone += Traces;
+	INC_DWORD_STAT_BY(STAT_L4D3_SightTraceCount, Traces);
+}
+
+void UZombiePerceptionSubsystem::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Perception: %lld pairs checked, %lld culled by range and cone, %lld traced, %lld traces skipped, %lld sightings"),
+		PairsChecked, PairsCulled, TracesDone, TracesSkipped, Sightings);
+}
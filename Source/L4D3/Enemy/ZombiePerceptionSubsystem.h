@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ZombiePerceptionSubsystem.generated.h"
+
+class APlayerCharacter;
+class UHordeSubsystem;
+
+struct FSightCandidate
+{
+	int32 ZombieIndex;
+	int32 SurvivorIndex;
+	float DistanceSquared;
+};
+
+/**
+ * Sight checks for every zombie against every survivor. Each frame a slice of the horde is
+ * range and cone culled four zombies at a time, then the closest candidates get a visibility
+ * trace up to a per frame cap. Every zombie is checked once per SightInterval.
+ */
+UCLASS()
+class L4D3_API UZombiePerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Tickable
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Stats
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	void GatherSurvivors();
+	void GatherSlice(const UHordeSubsystem& Horde, int32 Count);
+	void CullSlice();
+	void TraceCandidates(UHordeSubsystem& Horde);
+
+	// Next horde index to check
+	int32 Cursor;
+
+	// Survivors
+	TArray<APlayerCharacter*> Survivors;
+	TArray<FVector> SurvivorEyes;
+
+	// Zombies checked this frame, padded to a multiple of 4
+	TArray<int32> SliceIndices;
+	TArray<float> ZombieX;
+	TArray<float> ZombieY;
+	TArray<float> ZombieZ;
+	TArray<float> ForwardX;
+	TArray<float> ForwardY;
+	TArray<float> ForwardZ;
+	TArray<float> RadiusSquared;
+	TArray<float> CosineSquared;
+
+	TArray<FSightCandidate> Candidates;
+
+	// Stats
+	int64 PairsChecked;
+	int64 PairsCulled;
+	int64 TracesDone;
+	int64 TracesSkipped;
+	int64 Sightings;
+};
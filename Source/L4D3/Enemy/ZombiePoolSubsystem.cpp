@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombiePoolSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Core/L4D3Settings.h"
+
+static FAutoConsoleCommandWithWorld PoolStatsCommand(
+	TEXT("l4d3.Pool.Stats"),
+	TEXT("Log zombie pool hits, misses and spawn cost."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UZombiePoolSubsystem* Pool = World->GetSubsystem<UZombiePoolSubsystem>())
+		{
+			Pool->LogStats();
+		}
+	}));
+
+void UZombiePoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Zombies are spawned by the server and replicated, clients have nothing to pool
+	if (InWorld.GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	ZombieClass = Settings->ZombieClass.LoadSynchronous();
+	if (!ZombieClass)
+	{
+		ZombieClass = AZombieAI::StaticClass();
+	}
+
+	Prewarm(Settings->ZombiePoolSize);
+}
+
+bool UZombiePoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AZombieAI* UZombiePoolSubsystem::Acquire(const FTransform& SpawnTransform)
+{
+	L4D3_BENCHMARK_SCOPE(Spawning);
+
+	AZombieAI* Zombie = nullptr;
+	while (!Zombie && !FreeZombies.IsEmpty())
+	{
+		Zombie = FreeZombies.Pop(EAllowShrinking::No);
+		if (!IsValid(Zombie))
+		{
+			Zombie = nullptr;
+		}
+	}
+
+	if (Zombie)
+	{
+		Hits++;
+	}
+	else
+	{
+		// Pool is empty, spawn a new zombie
+		Misses++;
+		Zombie = SpawnPooledZombie();
+		if (!Zombie)
+		{
+			return nullptr;
+		}
+	}
+
+	Zombie->ActivateFromPool(SpawnTransform);
+
+	ActiveCount++;
+	PeakActiveCount = FMath::Max(PeakActiveCount, ActiveCount);
+
+	return Zombie;
+}
+
+void UZombiePoolSubsystem::Release(AZombieAI* Zombie)
+{
+	L4D3_BENCHMARK_SCOPE(Spawning);
+
+	if (!IsValid(Zombie) || FreeZombies.Contains(Zombie))
+	{
+		return;
+	}
+
+	Zombie->DeactivateToPool();
+	FreeZombies.Add(Zombie);
+	ActiveCount = FMath::Max(ActiveCount - 1, 0);
+}
+
+void UZombiePoolSubsystem::Prewarm(int32 Count)
+{
+	for (int32 i = 0; i < Count; i++)
+	{
+		if (AZombieAI* Zombie = SpawnPooledZombie())
+		{
+			FreeZombies.Add(Zombie);
+		}
+	}
+}
+
+AZombieAI* UZombiePoolSubsystem::SpawnPooledZombie()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Deferred so the zombie knows it's pooled before BeginPlay runs
+	AZombieAI* Zombie = GetWorld()->SpawnActorDeferred<AZombieAI>(ZombieClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (IsValid(Zombie))
+	{
+		Zombie->Pool = this;
+		Zombie->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+		Zombie->FinishSpawning(FTransform::Identity);
+	}
+
+	TotalSpawnSeconds += FPlatformTime::Seconds() - StartTime;
+	NumSpawned++;
+
+	return Zombie;
+}
+
+void UZombiePoolSubsystem::LogStats() const
+{
+	const int32 Requests = Hits + Misses;
+	UE_LOG(LogL4D3, Log, TEXT("Zombie pool: %d free, %d active (peak %d), %d hits, %d misses (%.1f%% hit rate), %d spawned, %.3f ms per spawn"),
+		FreeZombies.Num(), ActiveCount, PeakActiveCount, Hits, Misses, Requests > 0 ? 100.0 * Hits / Requests : 0.0, NumSpawned, GetAverageSpawnMs());
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "ZombiePoolSubsystem.generated.h"
+
+/**
+ * Spawns zombies up front when the level starts and hands them out on demand,
+ * so spawning a zombie during play doesn't pay for SpawnActor, BeginPlay and possession.
+ */
+UCLASS()
+class L4D3_API UZombiePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// Pool
+	AZombieAI* Acquire(const FTransform& SpawnTransform);
+	void Release(AZombieAI* Zombie);
+	void Prewarm(int32 Count);
+
+	TSubclassOf<AZombieAI> GetZombieClass() const { return ZombieClass; }
+	int32 NumFree() const { return FreeZombies.Num(); }
+	int32 NumActive() const { return ActiveCount; }
+
+	// Stats
+	int32 GetHits() const { return Hits; }
+	int32 GetMisses() const { return Misses; }
+	double GetAverageSpawnMs() const { return NumSpawned > 0 ? TotalSpawnSeconds * 1000.0 / NumSpawned : 0.0; }
+	void LogStats() const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	AZombieAI* SpawnPooledZombie();
+
+	UPROPERTY()
+	TSubclassOf<AZombieAI> ZombieClass;
+
+	UPROPERTY()
+	TArray<AZombieAI*> FreeZombies;
+
+	// Stats
+	int32 Hits;
+	int32 Misses;
+	int32 ActiveCount;
+	int32 PeakActiveCount;
+	int32 NumSpawned;
+	double TotalSpawnSeconds;
+};
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Enemy/ZombieSpatialGrid.h"
+
+FZombieSpatialGrid::FZombieSpatialGrid(float InCellSize)
+{
+	SetCellSize(InCellSize);
+}
+
+void FZombieSpatialGrid::SetCellSize(float InCellSize)
+{
+	check(InCellSize > 0.f);
+	CellSize = InCellSize;
+	InvCellSize = 1.f / InCellSize;
+}
+
+void FZombieSpatialGrid::Add(int32 Index, const FVector& Location)
+{
+	if (CellOfIndex.Num() <= Index)
+	{
+		CellOfIndex.SetNum(Index + 1);
+	}
+
+	const FIntPoint Cell = GetCell(Location);
+	CellOfIndex[Index] = Cell;
+	Cells.FindOrAdd(Cell).Add(Index);
+}
+
+void FZombieSpatialGrid::Update(int32 Index, const FVector& Location)
+{
+	// Only touch the map when the zombie crossed into another cell
+	const FIntPoint Cell = GetCell(Location);
+	if (Cell != CellOfIndex[Index])
+	{
+		RemoveFromCell(CellOfIndex[Index], Index);
+		CellOfIndex[Index] = Cell;
+		Cells.FindOrAdd(Cell).Add(Index);
+	}
+}
+
+void FZombieSpatialGrid::Remove(int32 Index)
+{
+	RemoveFromCell(CellOfIndex[Index], Index);
+}
+
+void FZombieSpatialGrid::Reindex(int32 OldIndex, int32 NewIndex)
+{
+	const FIntPoint Cell = CellOfIndex[OldIndex];
+	if (TArray<int32>* Indices = Cells.Find(Cell))
+	{
+		const int32 Slot = Indices->Find(OldIndex);
+		if (Slot != INDEX_NONE)
+		{
+			(*Indices)[Slot] = NewIndex;
+		}
+	}
+
+	CellOfIndex[NewIndex] = Cell;
+}
+
+void FZombieSpatialGrid::Reset()
+{
+	Cells.Reset();
+	CellOfIndex.Reset();
+}
+
+FIntPoint FZombieSpatialGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X * InvCellSize), FMath::FloorToInt32(Location.Y * InvCellSize));
+}
+
+void FZombieSpatialGrid::RemoveFromCell(const FIntPoint& Cell, int32 Index)
+{
+	if (TArray<int32>* Indices = Cells.Find(Cell))
+	{
+		// Empty cells are kept so zombies walking back and forth don't reallocate them
+		Indices->RemoveSingleSwap(Index, EAllowShrinking::No);
+	}
+}
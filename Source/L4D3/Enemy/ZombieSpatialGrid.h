@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform 2D hash grid of zombie indices, kept up to date as zombies move so "zombies near X"
+ * can be answered without a physics query. Indices are the zombies' HordeIndex.
+ */
+class L4D3_API FZombieSpatialGrid
+{
+public:
+
+	FZombieSpatialGrid(float InCellSize = 500.f);
+
+	void SetCellSize(float InCellSize);
+	float GetCellSize() const { return CellSize; }
+
+	// Entries
+	void Add(int32 Index, const FVector& Location);
+	void Update(int32 Index, const FVector& Location);
+	void Remove(int32 Index);
+	void Reindex(int32 OldIndex, int32 NewIndex);
+	void Reset();
+
+	// Finds every index whose location is within Radius of Center. Any allocator, so callers can query into inline storage
+	template<typename AllocatorType>
+	void QuerySphere(const FVector& Center, float Radius, TConstArrayView<FVector> Locations, TArray<int32, AllocatorType>& OutIndices) const;
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void RemoveFromCell(const FIntPoint& Cell, int32 Index);
+
+	float CellSize;
+	float InvCellSize;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+	TArray<FIntPoint> CellOfIndex;
+};
+
+template<typename AllocatorType>
+void FZombieSpatialGrid::QuerySphere(const FVector& Center, float Radius, TConstArrayView<FVector> Locations, TArray<int32, AllocatorType>& OutIndices) const
+{
+	const FIntPoint MinCell = GetCell(Center - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Center + FVector(Radius));
+	const double RadiusSquared = FMath::Square(Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			if (const TArray<int32>* Indices = Cells.Find(FIntPoint(X, Y)))
+			{
+				for (int32 Index : *Indices)
+				{
+					if (FVector::DistSquared(Locations[Index], Center) <= RadiusSquared)
+					{
+						OutIndices.Add(Index);
+					}
+				}
+			}
+		}
+	}
+}
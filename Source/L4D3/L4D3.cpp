@@ -3,4 +3,10 @@
 #include "L4D3.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogL4D3);
+
+#if !UE_BUILD_SHIPPING
+UE_TRACE_CHANNEL_DEFINE(L4D3Channel);
+#endif
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, L4D3, "L4D3" );
@@ -3,4 +3,21 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogL4D3, Log, All);
+
+// Gameplay profiling, "stat L4D3" in game and the L4D3 channel in Insights (-trace=cpu,L4D3)
+DECLARE_STATS_GROUP(TEXT("L4D3"), STATGROUP_L4D3, STATCAT_Advanced);
+
+// Cycle stat that also shows up as a named scope on the L4D3 trace channel, compiled out of shipping builds
+#if !UE_BUILD_SHIPPING
+UE_TRACE_CHANNEL_EXTERN(L4D3Channel, L4D3_API);
+
+#define L4D3_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, L4D3Channel)
+#else
+#define L4D3_SCOPE_CYCLE_COUNTER(Stat)
+#endif
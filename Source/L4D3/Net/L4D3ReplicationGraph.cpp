@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Net/L4D3ReplicationGraph.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Core/L4D3Settings.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Pickup/WeaponPickup.h"
+#include "L4D3/Player/PlayerCharacter.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Info.h"
+
+DECLARE_CYCLE_STAT(TEXT("Replication Graph"), STAT_L4D3_ReplicationGraph, STATGROUP_L4D3);
+
+static FAutoConsoleCommandWithWorld ReplicationStatsCommand(
+	TEXT("l4d3.Net.Stats"),
+	TEXT("Log the actors routed by the replication graph and how many zombies replicate at low frequency. Server only."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UL4D3ReplicationGraph* Graph = UL4D3ReplicationGraph::Get(World))
+		{
+			Graph->LogStats();
+		}
+		else
+		{
+			UE_LOG(LogL4D3, Log, TEXT("No L4D3 replication graph, run this on the server"));
+		}
+	}));
+
+UL4D3ReplicationGraph* UL4D3ReplicationGraph::Get(const UWorld* World)
+{
+	UNetDriver* NetDriver = IsValid(World) ? World->GetNetDriver() : nullptr;
+	return IsValid(NetDriver) ? Cast<UL4D3ReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+}
+
+void UL4D3ReplicationGraph::SetZombieLowFrequency(AZombieAI* Zombie, bool bLowFrequency)
+{
+	UL4D3ReplicationGraph* Graph = Get(Zombie->GetWorld());
+	if (!IsValid(Graph))
+	{
+		return;
+	}
+
+	FGlobalActorReplicationInfo* Info = Graph->GlobalActorReplicationInfoMap.Find(Zombie);
+	if (!Info)
+	{
+		return;
+	}
+
+	const uint16 PeriodFrame = bLowFrequency ? Graph->LowFrequencyPeriodFrame : Graph->ZombiePeriodFrame;
+	if (Info->Settings.ReplicationPeriodFrame != PeriodFrame)
+	{
+		Info->Settings.ReplicationPeriodFrame = PeriodFrame;
+		Graph->NumLowFrequency += bLowFrequency ? 1 : -1;
+	}
+}
+
+void UL4D3ReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	ZombiePeriodFrame = FMath::Max<uint16>(GetReplicationPeriodFrameForFrequency(Settings->ZombieNetUpdateFrequency), 1);
+	LowFrequencyPeriodFrame = FMath::Max<uint16>(GetReplicationPeriodFrameForFrequency(Settings->LowFrequencyZombieNetUpdateFrequency), 1);
+
+	// Zombies are culled well before the default character distance, a horde out of sight isn't worth the bandwidth
+	FClassReplicationInfo ZombieInfo;
+	ZombieInfo.SetCullDistanceSquared(FMath::Square(Settings->ZombieNetCullDistance));
+	ZombieInfo.ReplicationPeriodFrame = ZombiePeriodFrame;
+	GlobalActorReplicationInfoMap.SetClassInfo(AZombieAI::StaticClass(), ZombieInfo);
+
+	FClassReplicationInfo PickupInfo;
+	PickupInfo.SetCullDistanceSquared(FMath::Square(Settings->PickupNetCullDistance));
+	PickupInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(Settings->PickupNetUpdateFrequency);
+	GlobalActorReplicationInfoMap.SetClassInfo(AWeaponPickup::StaticClass(), PickupInfo);
+}
+
+void UL4D3ReplicationGraph::InitGlobalGraphNodes()
+{
+	Super::InitGlobalGraphNodes();
+
+	const UL4D3Settings* Settings = GetDefault<UL4D3Settings>();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = Settings->ReplicationGridCellSize;
+	GridNode->SpatialBias = Settings->ReplicationGridBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UL4D3ReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// The connection's own controller and view target
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+UL4D3ReplicationGraph::ERoute UL4D3ReplicationGraph::GetRoute(const AActor* Actor) const
+{
+	// Survivors, game state and player states are few and everyone needs them
+	if (Actor->bAlwaysRelevant || Actor->IsA<APlayerCharacter>() || Actor->IsA<AInfo>())
+	{
+		return ERoute::AlwaysRelevant;
+	}
+
+	// Player controllers only go to their owner, through the connection node
+	if (Actor->bOnlyRelevantToOwner)
+	{
+		return ERoute::None;
+	}
+
+	// Pickups sit still until picked up, dormant ones cost nothing to gather
+	if (Actor->IsA<AWeaponPickup>())
+	{
+		return ERoute::GridDormancy;
+	}
+
+	return ERoute::GridDynamic;
+}
+
+void UL4D3ReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	const ERoute Route = GetRoute(ActorInfo.Actor);
+	switch (Route)
+	{
+	case ERoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case ERoute::GridDynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case ERoute::GridDormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+
+	NumRouted[(uint8)Route]++;
+}
+
+void UL4D3ReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	const ERoute Route = GetRoute(ActorInfo.Actor);
+	switch (Route)
+	{
+	case ERoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case ERoute::GridDynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case ERoute::GridDormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+
+	NumRouted[(uint8)Route]--;
+
+	// Zombies leave at whatever rate they had
+	if (const FGlobalActorReplicationInfo* Info = GlobalActorReplicationInfoMap.Find(ActorInfo.Actor))
+	{
+		if (ActorInfo.Actor->IsA<AZombieAI>() && Info->Settings.ReplicationPeriodFrame == LowFrequencyPeriodFrame && LowFrequencyPeriodFrame != ZombiePeriodFrame)
+		{
+			NumLowFrequency--;
+		}
+	}
+}
+
+int32 UL4D3ReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_ReplicationGraph);
+
+	return Super::ServerReplicateActors(DeltaSeconds);
+}
+
+void UL4D3ReplicationGraph::LogStats() const
+{
+	UE_LOG(LogL4D3, Log, TEXT("Replication graph: %d connections, %d always relevant, %d dynamic and %d dormancy actors in the grid, %d through connection nodes, %d zombies at low frequency"),
+		Connections.Num(), NumRouted[(uint8)ERoute::AlwaysRelevant], NumRouted[(uint8)ERoute::GridDynamic], NumRouted[(uint8)ERoute::GridDormancy],
+		NumRouted[(uint8)ERoute::None], NumLowFrequency);
+}
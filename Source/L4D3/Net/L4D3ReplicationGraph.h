@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "L4D3ReplicationGraph.generated.h"
+
+class AZombieAI;
+
+/**
+ * Replication graph for co-op on dedicated servers. Zombies and pickups go in a 2D grid so each connection
+ * only considers the cells around its viewer, survivors and game info are relevant to everyone, and dormant,
+ * pooled or dead zombies replicate at a low rate. Enabled through ReplicationDriverClassName in DefaultEngine.ini.
+ */
+UCLASS(Transient)
+class L4D3_API UL4D3ReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	// Returns the world's replication graph, null on clients or when another driver is used
+	static UL4D3ReplicationGraph* Get(const UWorld* World);
+
+	// Lowers a zombie's replication rate while nothing about it changes, does nothing without the graph
+	static void SetZombieLowFrequency(AZombieAI* Zombie, bool bLowFrequency);
+
+	// UReplicationGraph
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	void LogStats() const;
+
+private:
+
+	// Where an actor is routed, must give the same answer when it's added and removed
+	enum class ERoute : uint8
+	{
+		// Handled by the per connection node (player controllers) or not replicated through the graph
+		None,
+		AlwaysRelevant,
+		GridDynamic,
+		GridDormancy
+	};
+
+	ERoute GetRoute(const AActor* Actor) const;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	uint16 ZombiePeriodFrame = 1;
+	uint16 LowFrequencyPeriodFrame = 1;
+
+	// Stats
+	int32 NumRouted[4] = {};
+	int32 NumLowFrequency = 0;
+};
@@ -2,8 +2,14 @@
 
 
 #include "L4D3/Pickup/WeaponPickup.h"
+#include "L4D3/L4D3.h"
 #include "Components/SphereComponent.h"
 #include "../Player/PlayerCharacter.h"
+#include "L4D3/DataAsset/GunData.h"
+#include "L4D3/Core/AssetStreamingSubsystem.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Overlap"), STAT_L4D3_PickupOverlap, STATGROUP_L4D3);
 
 // Sets default values
 AWeaponPickup::AWeaponPickup()
@@ -15,6 +21,11 @@ AWeaponPickup::AWeaponPickup()
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>("Mesh");
 	Mesh->SetupAttachment(SphereCollision);
 	Mesh->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
+
+	// Replicated so dropped items show up for every survivor, placed ones stay dormant until something changes
+	bReplicates = true;
+	SetReplicatingMovement(true);
+	NetDormancy = DORM_Initial;
 }
 
 // Called when the game starts or when spawned
@@ -22,12 +33,46 @@ void AWeaponPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Guns placed in the level start full
+	if (!bHasWeaponState)
+	{
+		WeaponState = FWeaponState::MakeFull(Cast<UGunData>(ItemData));
+		bHasWeaponState = true;
+	}
+
+	// Stream the mesh in, the streaming subsystem also preloads the held bundle once a survivor comes close
+	if (UAssetStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UAssetStreamingSubsystem>())
+	{
+		Streaming->RegisterPickup(this, FStreamableDelegate::CreateUObject(this, &AWeaponPickup::OnMeshLoaded));
+	}
+	else if (IsValid(ItemData))
+	{
+		Mesh->SetStaticMesh(ItemData->Mesh.LoadSynchronous());
+	}
+
 	FTimerHandle Timer;
 	GetWorld()->GetTimerManager().SetTimer(Timer, this, &AWeaponPickup::BeginPlayDelay, .5f);
 }
 
+void AWeaponPickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AWeaponPickup, ItemData, COND_InitialOnly);
+}
+
+void AWeaponPickup::OnMeshLoaded()
+{
+	if (IsValid(ItemData))
+	{
+		Mesh->SetStaticMesh(ItemData->Mesh.Get());
+	}
+}
+
 void AWeaponPickup::OnOverlapBegin(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_PickupOverlap);
+
 	APlayerCharacter* Player = Cast<APlayerCharacter>(OtherActor);
 	if (IsValid(Player))
 	{
@@ -37,6 +82,8 @@ void AWeaponPickup::OnOverlapBegin(UPrimitiveComponent* OverlappedComp, AActor*
 
 void AWeaponPickup::OnOverlapEnd(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_PickupOverlap);
+
 	APlayerCharacter* Player = Cast<APlayerCharacter>(OtherActor);
 	if (IsValid(Player))
 	{
@@ -48,10 +95,5 @@ void AWeaponPickup::BeginPlayDelay()
 {
 	SphereCollision->OnComponentBeginOverlap.AddDynamic(this, &AWeaponPickup::OnOverlapBegin);
 	SphereCollision->OnComponentEndOverlap.AddDynamic(this, &AWeaponPickup::OnOverlapEnd);
-
-	if (IsValid(ItemData))
-	{
-		Mesh->SetStaticMesh(ItemData->Mesh);
-	}
 }
 
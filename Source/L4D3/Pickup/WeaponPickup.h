@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "../DataAsset/ItemData.h"
+#include "L4D3/Core/WeaponState.h"
 #include "WeaponPickup.generated.h"
 
 UCLASS()
@@ -27,6 +28,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	UFUNCTION()
@@ -36,9 +39,18 @@ protected:
 
 	void BeginPlayDelay();
 
+	// Shows the item once its world bundle is streamed in
+	void OnMeshLoaded();
+
 public:
 
-	UPROPERTY(EditAnywhere, Category = "Item")
+	UPROPERTY(EditAnywhere, Replicated, Category = "Item")
 	UItemData* ItemData;
 
+	// Ammo of a dropped gun, placed guns start full
+	UPROPERTY(EditAnywhere, Category = "Item", meta = (EditCondition = "bHasWeaponState"))
+	FWeaponState WeaponState;
+	UPROPERTY(EditAnywhere, Category = "Item")
+	bool bHasWeaponState;
+
 };
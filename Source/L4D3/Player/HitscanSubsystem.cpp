@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "L4D3/Player/HitscanSubsystem.h"
+#include "L4D3/L4D3.h"
+#include "L4D3/Benchmark/BenchmarkTimings.h"
+#include "L4D3/Player/PlayerCharacter.h"
+#include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/DataAsset/GunData.h"
+#include "DrawDebugHelpers.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Fire"), STAT_L4D3_HitscanFire, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Hits"), STAT_L4D3_HitscanHits, STATGROUP_L4D3);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pellet Trace Count"), STAT_L4D3_PelletTraceCount, STATGROUP_L4D3);
+
+static TAutoConsoleVariable<bool> CVarDebugHitscan(
+	TEXT("l4d3.Hitscan.Debug"),
+	false,
+	TEXT("Draw every pellet trace."));
+
+void UHitscanSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TraceDelegate.BindUObject(this, &UHitscanSubsystem::OnTraceCompleted);
+}
+
+void UHitscanSubsystem::FireShot(APlayerCharacter* Shooter, const FVector& Start, const FVector& Direction, const UGunData* Gun)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_HitscanFire);
+	L4D3_BENCHMARK_SCOPE(Traces);
+
+	// Walls stop pellets, pawns are collected so pellets can pass through zombies
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(HitscanPellet));
+	Params.AddIgnoredActor(Shooter);
+
+	FPelletTrace Pellet;
+	Pellet.Damage = Gun->Damage;
+	Pellet.Penetration = Gun->Penetration;
+
+	const float SpreadRadians = FMath::DegreesToRadians(Gun->SpreadAngle);
+	for (int32 i = 0; i < FMath::Max(Gun->PelletsPerShot, 1); i++)
+	{
+		const FVector PelletDirection = SpreadRadians > 0.f ? FMath::VRandCone(Direction, SpreadRadians) : Direction;
+		const FVector End = Start + PelletDirection * Gun->BulletRange;
+
+		const uint32 PelletId = NextPelletId++;
+		PendingPellets.Add(PelletId, Pellet);
+		GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Multi, Start, End, ObjectParams, Params, &TraceDelegate, PelletId);
+		INC_DWORD_STAT(STAT_L4D3_PelletTraceCount);
+
+		// Debug
+		if (CVarDebugHitscan.GetValueOnGameThread())
+		{
+			DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.f);
+		}
+	}
+}
+
+void UHitscanSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_HitscanHits);
+	L4D3_BENCHMARK_SCOPE(Traces);
+
+	FPelletTrace Pellet;
+	if (!PendingPellets.RemoveAndCopyValue(Datum.UserData, Pellet))
+	{
+		return;
+	}
+
+	// Hits come back sorted along the trace
+	int32 PenetrationLeft = Pellet.Penetration;
+	const AActor* LastHitActor = nullptr;
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		AActor* HitActor = Hit.GetActor();
+		UPrimitiveComponent* HitComponent = Hit.GetComponent();
+		if (!IsValid(HitActor) || !IsValid(HitComponent) || HitActor == LastHitActor)
+		{
+			continue;
+		}
+
+		// Only what would block a visibility trace stops or takes a pellet, pickup spheres and triggers only overlap
+		if (HitComponent->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+		{
+			continue;
+		}
+		LastHitActor = HitActor;
+
+		if (AZombieAI* ZombieActor = Cast<AZombieAI>(HitActor))
+		{
+			// Bodies don't use up penetration
+			if (ZombieActor->IsDead())
+			{
+				continue;
+			}
+
+			ZombieActor->Damage(Pellet.Damage);
+
+			if (--PenetrationLeft < 0)
+			{
+				break;
+			}
+		}
+		else if (HitComponent->GetCollisionObjectType() != ECC_Pawn)
+		{
+			// Hit a wall
+			break;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "HitscanSubsystem.generated.h"
+
+class APlayerCharacter;
+class UGunData;
+
+struct FPelletTrace
+{
+	int32 Damage = 0;
+	int32 Penetration = 0;
+};
+
+/**
+ * Fires weapon traces for every survivor as async traces. All traces queued in a frame run
+ * together in the world's async trace batch and their hits are applied on the next frame.
+ */
+UCLASS()
+class L4D3_API UHitscanSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Queues one trace per pellet of Gun
+	void FireShot(APlayerCharacter* Shooter, const FVector& Start, const FVector& Direction, const UGunData* Gun);
+
+	int32 NumPendingTraces() const { return PendingPellets.Num(); }
+
+private:
+
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	FTraceDelegate TraceDelegate;
+
+	// Pellets waiting for their trace, keyed by the trace user data
+	TMap<uint32, FPelletTrace> PendingPellets;
+	uint32 NextPelletId;
+};
@@ -2,6 +2,7 @@
 
 
 #include "L4D3/Player/PlayerCharacter.h"
+#include "L4D3/L4D3.h"
 #include "InputMappingContext.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
@@ -10,12 +11,33 @@
 #include "Kismet/GameplayStatics.h"
 #include "Components/SphereComponent.h"
 #include "L4D3/Enemy/ZombieAI.h"
+#include "L4D3/Player/HitscanSubsystem.h"
+#include "L4D3/Audio/SoundSchedulerSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Survivor Shoot"), STAT_L4D3_SurvivorShoot, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Survivor Damage"), STAT_L4D3_SurvivorDamage, STATGROUP_L4D3);
+DECLARE_CYCLE_STAT(TEXT("Drop Item"), STAT_L4D3_DropItem, STATGROUP_L4D3);
+
+static FAutoConsoleCommand VerifySurvivorsCommand(
+	TEXT("l4d3.Net.VerifySurvivors"),
+	TEXT("Compare every client's copy of the survivors with the server's. Needs play in editor with the clients run under one process."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		int32 NumChecked = 0;
+		APlayerCharacter::VerifyReplicatedSurvivors(NumChecked);
+	}));
 
 // Sets default values
 APlayerCharacter::APlayerCharacter()
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = false;
+ 	// Only ticks on the server while the trigger is held, to run the fire loop
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Camera
 	Camera = CreateDefaultSubobject<UCameraComponent>("Camera");
@@ -31,10 +53,6 @@ APlayerCharacter::APlayerCharacter()
 	WalkSpeed = 450.f;
 	GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
 
-	// Shooting
-	bCanShoot = true;
-	TotalAmmo = 120;
-
 	// Health
 	MaxHealth = 100;
 	TemporaryHealthDecayRate = 3.f;
@@ -47,17 +65,213 @@ void APlayerCharacter::BeginPlay()
 
 	// Health
 	CurrentHealth = MaxHealth;
+	TemporaryHealthDecay.DecayPerSecond = TemporaryHealthDecayRate > 0.f ? 1.f / TemporaryHealthDecayRate : 0.f;
+	MarkHealthDirty();
+
+	// Weapons set on the blueprint start full
+	PrimaryWeaponState = FWeaponState::MakeFull(PrimaryWeapon);
+	SecondaryWeaponState = FWeaponState::MakeFull(SecondaryWeapon);
+	MarkWeaponStateDirty();
+}
+
+void APlayerCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Push based, these rarely change and are only compared once marked dirty
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	// Health
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, CurrentHealth, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, TemporaryHealthDecay, Params);
+
+	// Inventory
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, PrimaryWeapon, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, SecondaryWeapon, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, PrimaryHealingItem, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, SecondaryHealingItem, Params);
+
+	// Only the owner shows ammo
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, PrimaryWeaponState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, SecondaryWeaponState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, bIsReloading, Params);
+}
+
+void APlayerCharacter::MarkHealthDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, CurrentHealth, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, TemporaryHealthDecay, this);
+	RefreshTemporaryHealth();
+}
+
+void APlayerCharacter::OnRep_Health()
+{
+	RefreshTemporaryHealth();
+}
+
+void APlayerCharacter::RefreshTemporaryHealth()
+{
+	TemporaryHealth = GetTemporaryHealth();
+
+	// Only the local HUD reads it, other survivors don't need a timer
+	GetWorldTimerManager().ClearTimer(TemporaryHealthTimer);
+	if (TemporaryHealth > 0 && TemporaryHealthDecay.DecayPerSecond > 0.f && IsLocallyControlled())
+	{
+		const float Value = TemporaryHealthDecay.GetValue(GetHealthTime());
+		const float TimeToNextPoint = (Value - (TemporaryHealth - 1)) / TemporaryHealthDecay.DecayPerSecond;
+		GetWorldTimerManager().SetTimer(TemporaryHealthTimer, this, &APlayerCharacter::RefreshTemporaryHealth, FMath::Max(TimeToNextPoint, 0.01f));
+	}
+}
+
+void APlayerCharacter::MarkWeaponStateDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, PrimaryWeaponState, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, SecondaryWeaponState, this);
+	RefreshAmmoDisplay();
+}
+
+void APlayerCharacter::OnRep_WeaponState()
+{
+	RefreshAmmoDisplay();
+}
+
+void APlayerCharacter::OnRep_Inventory()
+{
+	// The server used up or dropped what this client has in hand
+	if (IsValid(EquippedItem) && EquippedItem != PrimaryWeapon && EquippedItem != SecondaryWeapon
+		&& EquippedItem != PrimaryHealingItem && EquippedItem != SecondaryHealingItem)
+	{
+		EquippedItem = nullptr;
+		ItemMesh->SetStaticMesh(nullptr);
+	}
+
+	RefreshAmmoDisplay();
+}
+
+void APlayerCharacter::RefreshAmmoDisplay()
+{
+	if (!IsLocallyControlled())
+	{
+		return;
+	}
+
+	TotalAmmo = PrimaryWeaponState.ReserveAmmo;
+	PrimaryAmmoInMag = PrimaryWeaponState.AmmoInMag;
+	SecondaryAmmoInMag = SecondaryWeaponState.AmmoInMag;
+}
+
+void APlayerCharacter::MarkInventoryDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, PrimaryWeapon, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, SecondaryWeapon, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, PrimaryHealingItem, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, SecondaryHealingItem, this);
+	MarkWeaponStateDirty();
+}
+
+bool APlayerCharacter::MatchesReplicatedState(const APlayerCharacter& Authority, bool bCompareOwnerOnly, FString& OutMismatch) const
+{
+	const TCHAR* Mismatch = nullptr;
+	if (CurrentHealth != Authority.CurrentHealth)
+	{
+		Mismatch = TEXT("CurrentHealth");
+	}
+	else if (TemporaryHealthDecay.BaseValue != Authority.TemporaryHealthDecay.BaseValue || TemporaryHealthDecay.StartTime != Authority.TemporaryHealthDecay.StartTime)
+	{
+		Mismatch = TEXT("TemporaryHealth");
+	}
+	else if (PrimaryWeapon != Authority.PrimaryWeapon || SecondaryWeapon != Authority.SecondaryWeapon)
+	{
+		Mismatch = TEXT("weapon slots");
+	}
+	else if (PrimaryHealingItem != Authority.PrimaryHealingItem || SecondaryHealingItem != Authority.SecondaryHealingItem)
+	{
+		Mismatch = TEXT("healing slots");
+	}
+	else if (bCompareOwnerOnly && !(PrimaryWeaponState == Authority.PrimaryWeaponState && SecondaryWeaponState == Authority.SecondaryWeaponState))
+	{
+		Mismatch = TEXT("weapon state");
+	}
 
-	FTimerHandle TempHealthTimer;
-	GetWorld()->GetTimerManager().SetTimer(TempHealthTimer, this, &APlayerCharacter::SubtractTempHealth, TemporaryHealthDecayRate, true);
+	if (Mismatch)
+	{
+		OutMismatch = FString::Printf(TEXT("%s differs from the server"), Mismatch);
+		return false;
+	}
+	return true;
+}
+
+int32 APlayerCharacter::VerifyReplicatedSurvivors(int32& OutNumChecked)
+{
+	OutNumChecked = 0;
+
+	// Find the server, survivors are matched to their client copies by player id
+	TMap<int32, const APlayerCharacter*> ServerSurvivors;
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (IsValid(World) && World->IsGameWorld() && (World->GetNetMode() == NM_ListenServer || World->GetNetMode() == NM_DedicatedServer))
+		{
+			for (TActorIterator<APlayerCharacter> It(World); It; ++It)
+			{
+				if (IsValid(It->GetPlayerState()))
+				{
+					ServerSurvivors.Add(It->GetPlayerState()->GetPlayerId(), *It);
+				}
+			}
+		}
+	}
+
+	if (ServerSurvivors.IsEmpty())
+	{
+		UE_LOG(LogL4D3, Log, TEXT("Survivor replication: no server with survivors found"));
+		return 0;
+	}
+
+	int32 NumMismatches = 0;
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (!IsValid(World) || !World->IsGameWorld() || World->GetNetMode() != NM_Client)
+		{
+			continue;
+		}
+
+		for (TActorIterator<APlayerCharacter> It(World); It; ++It)
+		{
+			const APlayerCharacter* const* Authority = IsValid(It->GetPlayerState()) ? ServerSurvivors.Find(It->GetPlayerState()->GetPlayerId()) : nullptr;
+			if (!Authority)
+			{
+				continue;
+			}
+
+			// Ammo only replicates to the survivor's own client
+			FString Mismatch;
+			OutNumChecked++;
+			if (!It->MatchesReplicatedState(**Authority, It->IsLocallyControlled(), Mismatch))
+			{
+				NumMismatches++;
+				UE_LOG(LogL4D3, Warning, TEXT("Survivor replication: %s on client %d, %s"), *It->GetName(), Context.PIEInstance, *Mismatch);
+			}
+		}
+	}
+
+	UE_LOG(LogL4D3, Log, TEXT("Survivor replication: %d client copies checked, %d mismatches"), OutNumChecked, NumMismatches);
+	return NumMismatches;
 }
-	
 
 // Called every frame
 void APlayerCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	// Fire loop, automatic guns shoot whenever the cooldown allows it
+	if (bWantsToFire && HasAuthority())
+	{
+		Fire();
+	}
 }
 
 // Called to bind functionality to input
@@ -84,8 +298,9 @@ void APlayerCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 		Input->BindAction(CrouchAction, ETriggerEvent::Triggered, this, &APlayerCharacter::StartCrouch);
 		Input->BindAction(CrouchAction, ETriggerEvent::Completed, this, &APlayerCharacter::EndCrouch);
 
-		Input->BindAction(FireAction, ETriggerEvent::Triggered, this, &APlayerCharacter::Fire);
+		Input->BindAction(FireAction, ETriggerEvent::Started, this, &APlayerCharacter::StartFire);
 		Input->BindAction(FireAction, ETriggerEvent::Completed, this, &APlayerCharacter::StopFire);
+		Input->BindAction(FireAction, ETriggerEvent::Canceled, this, &APlayerCharacter::StopFire);
 		Input->BindAction(ReloadAction, ETriggerEvent::Triggered, this, &APlayerCharacter::CallReload);
 
 		Input->BindAction(InteractAction, ETriggerEvent::Triggered, this, &APlayerCharacter::Interact);
@@ -143,11 +358,34 @@ void APlayerCharacter::EndCrouch()
 	GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
 }
 
+void APlayerCharacter::StartFire()
+{
+	// Clients send the press once, the server fires until the release arrives
+	if (!HasAuthority())
+	{
+		if (!bWantsToFire)
+		{
+			bWantsToFire = true;
+			ServerStartFire();
+		}
+		return;
+	}
+
+	bWantsToFire = true;
+	SetActorTickEnabled(true);
+	Fire();
+}
+
 void APlayerCharacter::Fire()
 {
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	if (UGunData* EquippedWeapon = Cast<UGunData>(EquippedItem))
 	{
-		if (EquippedWeapon->AmmoInMag > 0 && bCanShoot && !bIsReloading && (EquippedWeapon->bIsAutomatic || !bIsShooting))
+		if (CanShoot() && (EquippedWeapon->bIsAutomatic || !bIsShooting))
 		{
 			Shoot(EquippedWeapon);
 		}
@@ -160,47 +398,75 @@ void APlayerCharacter::Fire()
 
 void APlayerCharacter::Shoot(UGunData* EquippedWeapon)
 {
-	// Line Trace Setup
-	FVector StartLocation = Camera->GetComponentLocation();
-	FVector EndLocation = StartLocation + (Camera->GetComponentRotation().Vector() * EquippedWeapon->BulletRange);
-	FHitResult HitResult;
-	FCollisionQueryParams ColParams;
-	ColParams.AddIgnoredActor(this);
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_SurvivorShoot);
 
-	// Line Trace
-	bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, StartLocation, EndLocation, ECC_Visibility, ColParams);
-	if (bHit)
+	// Fire pellets, hits are applied next frame. Aim from the controller, the camera only follows it where it renders
+	if (UHitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UHitscanSubsystem>())
 	{
-		AZombieAI* ZombieActor = Cast<AZombieAI>(HitResult.GetActor());
-		if (IsValid(ZombieActor))
-		{
-			ZombieActor->Damage(EquippedWeapon->Damage);
-		}
+		Hitscan->FireShot(this, Camera->GetComponentLocation(), GetBaseAimRotation().Vector(), EquippedWeapon);
 	}
 
-	// Debug
-	DrawDebugLine(GetWorld(), StartLocation, EndLocation, FColor::Red, false, 1.f);
-
-	// Subtract ammo
-	EquippedWeapon->AmmoInMag--;
+	// Subtract ammo and start the cooldown
+	if (FWeaponState* State = GetWeaponState(EquippedWeapon))
+	{
+		State->AmmoInMag--;
+		State->NextFireTime = GetWorld()->GetTimeSeconds() + EquippedWeapon->TimeBetweenShots;
+		MarkWeaponStateDirty();
+	}
 
-	// Play gun sound
-	UGameplayStatics::PlaySound2D(GetWorld(), EquippedWeapon->GunSound);
+	// The shooter hears the shot
+	if (IsLocallyControlled())
+	{
+		PlayGunSound(EquippedWeapon);
+	}
+	else
+	{
+		ClientPlayGunSound(EquippedWeapon);
+	}
 
 	// Set is shooting
 	bIsShooting = true;
+}
 
-	// Time between shots
-	bCanShoot = false;
+void APlayerCharacter::PlayGunSound(UGunData* EquippedWeapon)
+{
+	if (!IsValid(EquippedWeapon))
+	{
+		return;
+	}
 
-	// Enable can shoot after delay
-	FTimerHandle TBSTimer;
-	GetWorld()->GetTimerManager().SetTimer(TBSTimer, this, &APlayerCharacter::EnableShooting, EquippedWeapon->TimeBetweenShots);
+	// Streamed in with the gun's held bundle
+	USoundBase* GunSound = EquippedWeapon->GunSound.LoadSynchronous();
+	if (USoundSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<USoundSchedulerSubsystem>())
+	{
+		Scheduler->RequestSound2D(GunSound, ESoundPriority::High);
+	}
+	else
+	{
+		UGameplayStatics::PlaySound2D(GetWorld(), GunSound);
+	}
+}
 
+void APlayerCharacter::ClientPlayGunSound_Implementation(UGunData* EquippedWeapon)
+{
+	PlayGunSound(EquippedWeapon);
 }
 
 void APlayerCharacter::StopFire()
 {
+	if (!HasAuthority())
+	{
+		if (bWantsToFire)
+		{
+			bWantsToFire = false;
+			ServerStopFire();
+		}
+		return;
+	}
+
+	bWantsToFire = false;
+	SetActorTickEnabled(false);
+
 	if (UGunData* EquippedWeapon = Cast<UGunData>(EquippedItem))
 	{
 		bIsShooting = false;
@@ -209,41 +475,64 @@ void APlayerCharacter::StopFire()
 
 void APlayerCharacter::CallReload()
 {
+	if (!HasAuthority())
+	{
+		ServerCallReload();
+		return;
+	}
+
 	UGunData* EquippedWeapon = Cast<UGunData>(EquippedItem);
 	if (!bIsReloading && IsValid(EquippedWeapon))
 	{
 		FTimerHandle ReloadTimer;
 		GetWorld()->GetTimerManager().SetTimer(ReloadTimer, this, &APlayerCharacter::Reload, 1);
 		bIsReloading = true;
+		MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, bIsReloading, this);
 	}
 }
 
 void APlayerCharacter::Reload()
 {
+	// Server only, clients ask through ServerCallReload
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	UGunData* EquippedWeapon = Cast<UGunData>(EquippedItem);
-	if (IsValid(EquippedWeapon) && EquippedWeapon == PrimaryWeapon)
+	FWeaponState* State = GetWeaponState(EquippedWeapon);
+	if (State && EquippedWeapon == PrimaryWeapon)
 	{
 		// Takes out ammo
-		TotalAmmo += EquippedWeapon->AmmoInMag;
-		EquippedWeapon->AmmoInMag = 0;
+		State->ReserveAmmo += State->AmmoInMag;
 
 		// Adds Ammo
-		EquippedWeapon->AmmoInMag = FMath::Clamp(EquippedWeapon->AmmoInMag + EquippedWeapon->BulletCapacity, 0, TotalAmmo);
-		TotalAmmo = FMath::Clamp(TotalAmmo - EquippedWeapon->BulletCapacity, 0, 990);
-
-		bIsReloading = false;
+		State->AmmoInMag = FMath::Min(EquippedWeapon->BulletCapacity, State->ReserveAmmo);
+		State->ReserveAmmo = FMath::Clamp(State->ReserveAmmo - State->AmmoInMag, 0, 990);
 	}
-	else
+	else if (State)
 	{
-		EquippedWeapon->AmmoInMag = EquippedWeapon->BulletCapacity;
-		bIsReloading = false;
+		State->AmmoInMag = EquippedWeapon->BulletCapacity;
 	}
+	MarkWeaponStateDirty();
+
+	bIsReloading = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, bIsReloading, this);
 }
 
 void APlayerCharacter::Damage(int32 Damage)
 {
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_SurvivorDamage);
+
+	// Server only, health replicates to clients
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// Check if player has temporary health
-	if (TemporaryHealth <= 0)
+	const int32 TempHealth = GetTemporaryHealth();
+	if (TempHealth <= 0)
 	{
 		// Subtract health
 		CurrentHealth = FMath::Clamp(CurrentHealth -= Damage, 0, MaxHealth);
@@ -257,20 +546,27 @@ void APlayerCharacter::Damage(int32 Damage)
 	else
 	{
 		// Subtract temporary health
-		TemporaryHealth = FMath::Clamp(TemporaryHealth -= Damage, 0, MaxHealth);
+		TemporaryHealthDecay.SetValue(FMath::Clamp(TempHealth - Damage, 0, MaxHealth), GetHealthTime());
 	}
-
+	MarkHealthDirty();
 }
 
 void APlayerCharacter::Heal(int32 HealthToAdd, bool bIsTemporary)
 {
+	// Server only, health replicates to clients
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	if (CurrentHealth < MaxHealth)
 	{
 		if (bIsTemporary)
 		{
-			if (CurrentHealth + TemporaryHealth < MaxHealth)
+			const int32 TempHealth = GetTemporaryHealth();
+			if (CurrentHealth + TempHealth < MaxHealth)
 			{
-				TemporaryHealth = FMath::Clamp(TemporaryHealth += HealthToAdd, 0, MaxHealth - CurrentHealth);
+				TemporaryHealthDecay.SetValue(FMath::Clamp(TempHealth + HealthToAdd, 0, MaxHealth - CurrentHealth), GetHealthTime());
 			}
 		}
 		else
@@ -278,29 +574,84 @@ void APlayerCharacter::Heal(int32 HealthToAdd, bool bIsTemporary)
 			CurrentHealth = FMath::Clamp(CurrentHealth += HealthToAdd, 0, MaxHealth);
 		}
 
-		if (EquippedItem->ItemType = EItemType::Primary)
-		{
-			PrimaryHealingItem = nullptr;
-		}
-		else
+		MarkHealthDirty();
+
+		// Use up the healing item in hand
+		if (Cast<UHealthItemData>(EquippedItem))
 		{
-			SecondaryHealingItem = nullptr;
+			if (EquippedItem->ItemType == EItemType::Primary)
+			{
+				PrimaryHealingItem = nullptr;
+			}
+			else
+			{
+				SecondaryHealingItem = nullptr;
+			}
+
+			EquippedItem = nullptr;
+			ItemMesh->SetStaticMesh(nullptr);
+			MarkInventoryDirty();
 		}
+	}
+}
 
-		EquippedItem = nullptr;
-		ItemMesh->SetStaticMesh(nullptr);
+FWeaponState* APlayerCharacter::GetWeaponState(const UItemData* Weapon)
+{
+	if (!IsValid(Weapon))
+	{
+		return nullptr;
+	}
+	if (Weapon == PrimaryWeapon)
+	{
+		return &PrimaryWeaponState;
 	}
+	if (Weapon == SecondaryWeapon)
+	{
+		return &SecondaryWeaponState;
+	}
+	return nullptr;
+}
 
+FWeaponState APlayerCharacter::GetEquippedWeaponState() const
+{
+	if (IsValid(EquippedItem) && EquippedItem == PrimaryWeapon)
+	{
+		return PrimaryWeaponState;
+	}
+	if (IsValid(EquippedItem) && EquippedItem == SecondaryWeapon)
+	{
+		return SecondaryWeaponState;
+	}
+	return FWeaponState();
 }
 
-void APlayerCharacter::SubtractTempHealth()
+bool APlayerCharacter::CanShoot() const
 {
-	TemporaryHealth = FMath::Clamp(TemporaryHealth = TemporaryHealth - 1, 0, MaxHealth - CurrentHealth);
+	return Cast<UGunData>(EquippedItem) && !bIsReloading && GetEquippedWeaponState().CanFire(GetWorld()->GetTimeSeconds());
+}
+
+double APlayerCharacter::GetHealthTime() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	return IsValid(GameState) ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+int32 APlayerCharacter::GetTemporaryHealth() const
+{
+	// Rounded up, so a point is only gone once it has fully drained
+	const float Value = TemporaryHealthDecay.GetValue(GetHealthTime());
+	return FMath::Clamp(FMath::CeilToInt32(Value - KINDA_SMALL_NUMBER), 0, FMath::Max(MaxHealth - CurrentHealth, 0));
 }
 
 
 void APlayerCharacter::Interact()
 {
+	if (!HasAuthority())
+	{
+		ServerInteract();
+		return;
+	}
+
 	// Pickup gun
 	if (IsValid(ItemInRange))
 	{
@@ -308,19 +659,24 @@ void APlayerCharacter::Interact()
 		UItemData* Item = ItemInRange->ItemData;
 		if (UGunData* Gun = Cast<UGunData>(Item))
 		{
+			// The pickup's ammo comes with it
+			const FWeaponState PickupState = ItemInRange->bHasWeaponState ? ItemInRange->WeaponState : FWeaponState::MakeFull(Gun);
+
 			if (Gun->ItemType == EItemType::Primary)
 			{
-				DropItem(PrimaryWeapon);
+				DropItem(PrimaryWeapon, &PrimaryWeaponState);
 
 				// Pickup weapon
 				PrimaryWeapon = Gun;
+				PrimaryWeaponState = PickupState;
 			}
 			else
 			{
-				DropItem(SecondaryWeapon);
+				DropItem(SecondaryWeapon, &SecondaryWeaponState);
 
 				// Pickup weapon
 				SecondaryWeapon = Gun;
+				SecondaryWeaponState = PickupState;
 			}
 		}
 		// If healing
@@ -346,6 +702,8 @@ void APlayerCharacter::Interact()
 		//EquippedItem = Item;
 		//ItemMesh->SetStaticMesh(Item->Mesh);
 
+		MarkInventoryDirty();
+
 		// Destroy pickup
 		ItemInRange->Destroy();
 	}
@@ -353,6 +711,16 @@ void APlayerCharacter::Interact()
 
 void APlayerCharacter::DropEquippedItem()
 {
+	if (!HasAuthority())
+	{
+		ServerDropEquippedItem();
+		return;
+	}
+
+	// Keep the ammo before the slot is cleared
+	const FWeaponState* State = GetWeaponState(EquippedItem);
+	const FWeaponState DroppedState = State ? *State : FWeaponState();
+
 	switch (ItemEquippedEnum)
 	{
 	case EPrimaryWeapon:
@@ -369,20 +737,94 @@ void APlayerCharacter::DropEquippedItem()
 		break;
 	}
 
-	DropItem(EquippedItem);
+	DropItem(EquippedItem, State ? &DroppedState : nullptr);
 	EquippedItem = nullptr;
 	ItemMesh->SetStaticMesh(nullptr);
+	MarkInventoryDirty();
 }
 
-void APlayerCharacter::DropItem(UItemData* Item)
+void APlayerCharacter::DropItem(UItemData* Item, const FWeaponState* WeaponState)
 {
+	L4D3_SCOPE_CYCLE_COUNTER(STAT_L4D3_DropItem);
+
+	// Server only, pickups are spawned by the server and replicated
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	if (IsValid(Item))
 	{
 		AWeaponPickup* ItemDrop = GetWorld()->SpawnActor<AWeaponPickup>(GetActorLocation(), GetActorRotation());
 		ItemDrop->ItemData = Item;
-		ItemDrop->Mesh->SetStaticMesh(Item->Mesh);
+		if (WeaponState)
+		{
+			ItemDrop->WeaponState = *WeaponState;
+			ItemDrop->bHasWeaponState = true;
+		}
+		ItemDrop->Mesh->SetStaticMesh(Item->Mesh.LoadSynchronous());
 		ItemDrop->SphereCollision->SetSimulatePhysics(true);
 
 		GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::White, (TEXT("Item Dropped: %s"), Item->GetName()));
 	}
 }
+
+void APlayerCharacter::SetItemEquippedEnum(EItemEquipped Item)
+{
+	ItemEquippedEnum = Item;
+
+	// The server picks the same slot, fire, heal and drop act on what it has equipped
+	if (!HasAuthority())
+	{
+		ServerSetItemEquippedEnum(Item);
+	}
+}
+
+void APlayerCharacter::ServerSetItemEquippedEnum_Implementation(EItemEquipped Item)
+{
+	ItemEquippedEnum = Item;
+
+	switch (Item)
+	{
+	case EPrimaryWeapon:
+		EquippedItem = PrimaryWeapon;
+		break;
+	case ESecondaryWeapon:
+		EquippedItem = SecondaryWeapon;
+		break;
+	case EPrimaryHealing:
+		EquippedItem = PrimaryHealingItem;
+		break;
+	case ESecondaryHealing:
+		EquippedItem = SecondaryHealingItem;
+		break;
+	default:
+		EquippedItem = nullptr;
+		break;
+	}
+}
+
+void APlayerCharacter::ServerStartFire_Implementation()
+{
+	StartFire();
+}
+
+void APlayerCharacter::ServerStopFire_Implementation()
+{
+	StopFire();
+}
+
+void APlayerCharacter::ServerCallReload_Implementation()
+{
+	CallReload();
+}
+
+void APlayerCharacter::ServerInteract_Implementation()
+{
+	Interact();
+}
+
+void APlayerCharacter::ServerDropEquippedItem_Implementation()
+{
+	DropEquippedItem();
+}
@@ -8,6 +8,8 @@
 #include "L4D3/DataAsset/GunData.h"
 #include "L4D3/DataAsset/HealthItemData.h"
 #include "L4D3/Pickup/WeaponPickup.h"
+#include "L4D3/Core/DecayingStat.h"
+#include "L4D3/Core/WeaponState.h"
 #include "PlayerCharacter.generated.h"
 
 UENUM(BlueprintType)
@@ -25,6 +27,13 @@ class L4D3_API APlayerCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// Streams in the held bundle of the survivor's loadout
+	friend class UAssetStreamingSubsystem;
+	// Drives the survivor in the benchmark scenarios
+	friend class UHordeBenchmarkSubsystem;
+	// Changes survivor state on the server and clients in the replication test
+	friend class FSurvivorReplicationTest;
+
 protected:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
@@ -73,6 +82,8 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	// Movement
@@ -89,55 +100,109 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "MoveSpeed")
 	float WalkSpeed;
 
-	// Use Item
+	// Use Item. StartFire and StopFire follow the trigger, Fire is one attempt on the server
+	void StartFire();
 	void Fire();
 	void StopFire();
+	bool bWantsToFire;
+
+	// Actions that change replicated state run on the server, clients ask for them through these
+	UFUNCTION(Server, Reliable)
+	void ServerStartFire();
+	UFUNCTION(Server, Reliable)
+	void ServerStopFire();
+	UFUNCTION(Server, Reliable)
+	void ServerCallReload();
+	UFUNCTION(Server, Reliable)
+	void ServerInteract();
+	UFUNCTION(Server, Reliable)
+	void ServerDropEquippedItem();
+	UFUNCTION(Server, Reliable)
+	void ServerSetItemEquippedEnum(EItemEquipped Item);
 
 	UPROPERTY(BlueprintReadWrite)
 	UItemData* EquippedItem;
 	
 	// Weapons
 	void Shoot(UGunData* EquippedWeapon);
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Items")
+	void PlayGunSound(UGunData* EquippedWeapon);
+	UFUNCTION(Client, Unreliable)
+	void ClientPlayGunSound(UGunData* EquippedWeapon);
+	UPROPERTY(ReplicatedUsing = OnRep_Inventory, EditAnywhere, BlueprintReadOnly, Category = "Items")
 	UGunData* PrimaryWeapon;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Items")
+	UPROPERTY(ReplicatedUsing = OnRep_Inventory, EditAnywhere, BlueprintReadOnly, Category = "Items")
 	UGunData* SecondaryWeapon;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 TotalAmmo;
-	UPROPERTY(BlueprintReadOnly)
-	bool bCanShoot;
-	UPROPERTY(BlueprintReadOnly)
+	UPROPERTY(Replicated, BlueprintReadOnly)
 	bool bIsReloading;
 	UPROPERTY(BlueprintReadOnly)
 	bool bIsShooting;
 
+	// Ammo and cooldown of the weapon in each slot, the gun assets themselves are never modified
+	UPROPERTY(ReplicatedUsing = OnRep_WeaponState, BlueprintReadOnly, Category = "Items")
+	FWeaponState PrimaryWeaponState;
+	UPROPERTY(ReplicatedUsing = OnRep_WeaponState, BlueprintReadOnly, Category = "Items")
+	FWeaponState SecondaryWeaponState;
+
+	FWeaponState* GetWeaponState(const UItemData* Weapon);
+
+	UFUNCTION(BlueprintPure)
+	bool CanShoot() const;
+
+	// HUD copies for WB_HUD's bindings, the primary weapon's reserve and each slot's magazine.
+	// Only the locally controlled survivor writes them
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 TotalAmmo;
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 PrimaryAmmoInMag;
+	UPROPERTY(BlueprintReadOnly, Category = "Items")
+	int32 SecondaryAmmoInMag;
+	void RefreshAmmoDisplay();
+
+	UFUNCTION()
+	void OnRep_WeaponState();
+
 	void CallReload();
 	UFUNCTION(BlueprintCallable)
 	void Reload();
-	void EnableShooting() { bCanShoot = true; }
 
 	// Healing
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Items")
+	UPROPERTY(ReplicatedUsing = OnRep_Inventory, EditAnywhere, BlueprintReadOnly, Category = "Items")
 	UHealthItemData* PrimaryHealingItem;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Items")
+	UPROPERTY(ReplicatedUsing = OnRep_Inventory, EditAnywhere, BlueprintReadOnly, Category = "Items")
 	UHealthItemData* SecondaryHealingItem;
 
+	// Unequips an item the server took out of its slot
+	UFUNCTION()
+	void OnRep_Inventory();
+
 
 	// Health
 	UFUNCTION(BlueprintCallable)
 	void Heal(int32 HealthToAdd, bool bIsTemporary = false);
 
-	void SubtractTempHealth();
-
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health")
 	int32 MaxHealth;
-	UPROPERTY(BlueprintReadWrite)
+	UPROPERTY(ReplicatedUsing = OnRep_Health, BlueprintReadOnly)
 	int32 CurrentHealth;
+	UPROPERTY(ReplicatedUsing = OnRep_Health)
+	FDecayingStat TemporaryHealthDecay;
+
+	// HUD copy of GetTemporaryHealth, WB_HUD binds it. Only the locally controlled survivor keeps it
+	// current, with a timer that fires when the next point has drained
 	UPROPERTY(BlueprintReadOnly)
 	int32 TemporaryHealth;
+	FTimerHandle TemporaryHealthTimer;
+	void RefreshTemporaryHealth();
+
+	UFUNCTION()
+	void OnRep_Health();
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health")
 	float TemporaryHealthDecayRate;
 
+	// Server world time, so temporary health drains the same on every machine
+	double GetHealthTime() const;
+
 	// When below 40, slow down movement
 
 	// Interact
@@ -145,13 +210,18 @@ protected:
 
 	// Items
 	void DropEquippedItem();
-	void DropItem(UItemData* Item);
+	void DropItem(UItemData* Item, const FWeaponState* WeaponState = nullptr);
 	
 	UFUNCTION(BlueprintCallable)
-	void SetItemEquippedEnum(EItemEquipped Item) { ItemEquippedEnum = Item; }
+	void SetItemEquippedEnum(EItemEquipped Item);
 
 	EItemEquipped ItemEquippedEnum;
 
+	// Health, ammo and inventory are push based, anything that changes them marks them dirty. Server only
+	void MarkHealthDirty();
+	void MarkWeaponStateDirty();
+	void MarkInventoryDirty();
+
 public:
 
 	UPROPERTY(BlueprintReadOnly)
@@ -159,4 +229,25 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	void Damage(int32 Damage);
+
+	// Temporary health drains by one point every TemporaryHealthDecayRate seconds
+	UFUNCTION(BlueprintPure)
+	int32 GetTemporaryHealth() const;
+
+	// Ammo
+	UFUNCTION(BlueprintPure)
+	FWeaponState GetEquippedWeaponState() const;
+	UFUNCTION(BlueprintPure)
+	FWeaponState GetPrimaryWeaponState() const { return PrimaryWeaponState; }
+	UFUNCTION(BlueprintPure)
+	FWeaponState GetSecondaryWeaponState() const { return SecondaryWeaponState; }
+
+	bool IsDead() const { return CurrentHealth <= 0; }
+
+	// Compares the replicated state with the server's copy of this survivor, false and the first difference if they disagree
+	bool MatchesReplicatedState(const APlayerCharacter& Authority, bool bCompareOwnerOnly, FString& OutMismatch) const;
+
+	// Compares every client copy of every survivor with the server's, for play in editor sessions run under one process.
+	// Returns the number of mismatches, each one is logged
+	static int32 VerifyReplicatedSurvivors(int32& OutNumChecked);
 };
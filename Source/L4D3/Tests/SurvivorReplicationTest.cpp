@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "L4D3/Player/PlayerCharacter.h"
+#include "Editor.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+#include "EngineUtils.h"
+
+/**
+ * Starts a listen server with one client under one process, changes survivor health and inventory
+ * on the server and through the client's server RPCs, then checks the client copies match the server.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurvivorReplicationTest, "L4D3.Net.SurvivorReplication", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+namespace SurvivorReplicationTest
+{
+	static const TCHAR* MapName = TEXT("/Game/L4D3/Maps/Playground");
+	static const double SessionTimeout = 30.0;
+
+	// Survivors with a player state in the first game world running as NetMode
+	static TArray<APlayerCharacter*> GetSurvivors(ENetMode NetMode)
+	{
+		TArray<APlayerCharacter*> Survivors;
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (IsValid(World) && World->IsGameWorld() && World->GetNetMode() == NetMode)
+			{
+				for (TActorIterator<APlayerCharacter> It(World); It; ++It)
+				{
+					if (IsValid(It->GetPlayerState()))
+					{
+						Survivors.Add(*It);
+					}
+				}
+				break;
+			}
+		}
+		return Survivors;
+	}
+}
+
+bool FSurvivorReplicationTest::RunTest(const FString& Parameters)
+{
+	using namespace SurvivorReplicationTest;
+
+	ADD_LATENT_AUTOMATION_COMMAND(FEditorLoadMap(MapName));
+
+	// Listen server plus one client
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([]()
+	{
+		ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+		PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+		PlaySettings->SetPlayNumberOfClients(2);
+		PlaySettings->SetRunUnderOneProcess(true);
+
+		FRequestPlaySessionParams Params;
+		Params.WorldType = EPlaySessionWorldType::PlayInEditor;
+		Params.EditorPlaySettings = PlaySettings;
+		GEditor->RequestPlaySession(Params);
+		return true;
+	}));
+
+	// Wait until the client sees both survivors
+	const double StartTime = FPlatformTime::Seconds();
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, StartTime]()
+	{
+		if (GetSurvivors(NM_ListenServer).Num() >= 2 && GetSurvivors(NM_Client).Num() >= 2)
+		{
+			return true;
+		}
+		if (FPlatformTime::Seconds() - StartTime > SessionTimeout)
+		{
+			AddError(TEXT("Play session didn't start with two survivors in time"));
+			return true;
+		}
+		return false;
+	}));
+
+	// Change state on the server and through the client's RPCs
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this]()
+	{
+		for (APlayerCharacter* Survivor : GetSurvivors(NM_ListenServer))
+		{
+			Survivor->Damage(30);
+			Survivor->Heal(10, true);
+		}
+
+		for (APlayerCharacter* Survivor : GetSurvivors(NM_Client))
+		{
+			if (!Survivor->IsLocallyControlled())
+			{
+				continue;
+			}
+
+			// Mutators don't touch the client copy, only replication does
+			const int32 Health = Survivor->CurrentHealth;
+			Survivor->Heal(20);
+			TestEqual(TEXT("Client side heal changes nothing locally"), Survivor->CurrentHealth, Health);
+
+			Survivor->SetItemEquippedEnum(EPrimaryWeapon);
+			Survivor->CallReload();
+			Survivor->Interact();
+			Survivor->DropEquippedItem();
+		}
+		return true;
+	}));
+
+	// Give the changes time to replicate
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitLatentCommand(2.f));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this]()
+	{
+		int32 NumChecked = 0;
+		const int32 NumMismatches = APlayerCharacter::VerifyReplicatedSurvivors(NumChecked);
+		TestTrue(TEXT("Client copies of the survivors were checked"), NumChecked > 0);
+		TestEqual(TEXT("Client copies match the server"), NumMismatches, 0);
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+
+	return true;
+}
+
+#endif
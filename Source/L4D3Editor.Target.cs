@@ -11,5 +11,8 @@ public class L4D3EditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V5;
 
 		ExtraModuleNames.AddRange( new string[] { "L4D3" } );
+
+		// Survivor health and inventory replicate with push model dirty marking
+		bWithPushModel = true;
 	}
 }